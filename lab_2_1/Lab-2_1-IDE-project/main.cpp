@@ -6,20 +6,363 @@
 #include <sstream>
 #include <iomanip>
 #include <limits>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <tuple>
+#include <memory>
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#endif
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <cstdio>
+#include <chrono>
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
+#include <deque>
+#include <cerrno>
+#include <cmath>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+// Арена й індекси побудовані на std::pmr. Старі libc++ від Apple його не мають або вимикають
+// для цільових macOS, старіших за 14 — тоді краще зрозуміла помилка, ніж сотні невизначених імен
+#ifndef __cpp_lib_memory_resource
+#error "std::pmr is required: GCC 9+, LLVM libc++ 16+, or Apple clang 15+ (Xcode 15) targeting macOS 14+"
+#endif
+
+// Хеш-функція FNV-1a для рядків (використовується індексом за назвою)
+inline std::uint64_t hashString(std::string_view text) {
+    std::uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : text) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// Хеш-таблиця з відкритою адресацією (лінійне зондування), ключем якої є рядок.
+// Таблиця не копіює ключі: рядок, на який вказує ключ, має жити, поки існує запис.
+template <typename Value>
+class StringHashMap {
+    enum SlotState : std::uint8_t { Empty, Used, Deleted };
+
+    struct Slot {
+        std::uint64_t hash = 0;  // Збережений хеш ключа
+        std::string_view key;    // Ключ (вказує на зовнішній рядок)
+        Value value{};           // Значення
+        SlotState state = Empty; // Стан комірки
+    };
+
+    std::vector<Slot> slots;  // Комірки таблиці (розмір — степінь двійки)
+    std::size_t used = 0;     // Кількість зайнятих комірок
+    std::size_t deleted = 0;  // Кількість видалених комірок ("надгробків")
+
+    // Шукає комірку з ключем; повертає індекс або slots.size(), якщо не знайдено
+    std::size_t findIndex(std::string_view key, std::uint64_t hash) const;
+    
+    // Перебудовує таблицю з новою місткістю
+    void rehash(std::size_t capacity);
+
+public:
+    // Повертає вказівник на значення або nullptr, якщо ключа немає
+    Value* find(std::string_view key);
+    const Value* find(std::string_view key) const;
+    
+    // Повертає значення для ключа, створюючи його за потреби
+    Value& insert(std::string_view key, bool& inserted);
+    
+    // Видаляє ключ з таблиці
+    bool erase(std::string_view key);
+    
+    // Замінює збережений ключ на інший рядок з тим самим вмістом
+    bool rebind(std::string_view key);
+    
+    // Резервує місце для заданої кількості ключів
+    void reserve(std::size_t count);
+    
+    // Очищає таблицю
+    void clear();
+    
+    std::size_t size() const { return used; }
+};
+
+template <typename Value>
+std::size_t StringHashMap<Value>::findIndex(std::string_view key, std::uint64_t hash) const {
+    if (slots.empty()) {
+        return 0;
+    }
+    std::size_t mask = slots.size() - 1;
+    for (std::size_t i = hash & mask;; i = (i + 1) & mask) {
+        const Slot& slot = slots[i];
+        if (slot.state == Empty) {
+            return slots.size();  // Порожня комірка завершує ланцюжок зондування
+        }
+        if (slot.state == Used && slot.hash == hash && slot.key == key) {
+            return i;
+        }
+    }
+}
+
+template <typename Value>
+void StringHashMap<Value>::rehash(std::size_t capacity) {
+    std::vector<Slot> old(capacity);
+    old.swap(slots);
+    deleted = 0;
+    std::size_t mask = slots.size() - 1;
+    for (Slot& slot : old) {
+        if (slot.state == Used) {
+            std::size_t i = slot.hash & mask;
+            while (slots[i].state != Empty) {
+                i = (i + 1) & mask;
+            }
+            slots[i] = std::move(slot);
+        }
+    }
+}
+
+template <typename Value>
+Value* StringHashMap<Value>::find(std::string_view key) {
+    std::size_t i = findIndex(key, hashString(key));
+    return i < slots.size() ? &slots[i].value : nullptr;
+}
+
+template <typename Value>
+const Value* StringHashMap<Value>::find(std::string_view key) const {
+    std::size_t i = findIndex(key, hashString(key));
+    return i < slots.size() ? &slots[i].value : nullptr;
+}
+
+template <typename Value>
+Value& StringHashMap<Value>::insert(std::string_view key, bool& inserted) {
+    std::uint64_t hash = hashString(key);
+    std::size_t found = findIndex(key, hash);
+    if (found < slots.size()) {
+        inserted = false;
+        return slots[found].value;
+    }
+
+    // Заповненість (разом із "надгробками") не перевищує 70%
+    if ((used + deleted + 1) * 10 > slots.size() * 7) {
+        std::size_t capacity = slots.empty() ? 16 : slots.size();
+        while ((used + 1) * 10 > capacity * 5) {
+            capacity *= 2;
+        }
+        rehash(capacity);
+    }
+
+    std::size_t mask = slots.size() - 1;
+    std::size_t i = hash & mask;
+    while (slots[i].state == Used) {
+        i = (i + 1) & mask;
+    }
+    if (slots[i].state == Deleted) {
+        --deleted;
+    }
+    slots[i].hash = hash;
+    slots[i].key = key;
+    slots[i].value = Value{};
+    slots[i].state = Used;
+    ++used;
+    inserted = true;
+    return slots[i].value;
+}
+
+template <typename Value>
+bool StringHashMap<Value>::erase(std::string_view key) {
+    std::size_t i = findIndex(key, hashString(key));
+    if (i >= slots.size()) {
+        return false;
+    }
+    slots[i].key = std::string_view();
+    slots[i].value = Value{};
+    slots[i].state = Deleted;
+    --used;
+    ++deleted;
+    return true;
+}
+
+template <typename Value>
+bool StringHashMap<Value>::rebind(std::string_view key) {
+    std::size_t i = findIndex(key, hashString(key));
+    if (i >= slots.size()) {
+        return false;
+    }
+    slots[i].key = key;
+    return true;
+}
+
+template <typename Value>
+void StringHashMap<Value>::reserve(std::size_t count) {
+    std::size_t capacity = 16;
+    while (count * 10 > capacity * 7) {
+        capacity *= 2;
+    }
+    if (capacity > slots.size()) {
+        rehash(capacity);
+    }
+}
+
+template <typename Value>
+void StringHashMap<Value>::clear() {
+    slots.clear();
+    used = 0;
+    deleted = 0;
+}
+
+// Кількість днів від 1970-01-01 до заданої дати (без викликів mktime та часового поясу)
+inline std::int32_t daysFromCivil(int year, int month, int day) {
+    year -= month <= 2;
+    const int era = (year >= 0 ? year : year - 399) / 400;
+    const int yearOfEra = year - era * 400;
+    const int dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    const int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+// Номер дня для дати у std::tm (поля, що виходять за межі місяця, переносяться як у mktime)
+inline std::int32_t dayNumber(const std::tm& date) {
+    int year = date.tm_year + 1900 + date.tm_mon / 12;
+    int month = date.tm_mon % 12;
+    if (month < 0) {
+        month += 12;
+        --year;
+    }
+    return daysFromCivil(year, month + 1, 1) + date.tm_mday - 1;
+}
+
+// Номер сьогоднішнього дня за місцевим часом
+inline std::int32_t currentDay() {
+    std::time_t now = std::time(nullptr);
+    return dayNumber(*std::localtime(&now));
+}
+
+// Дата (рік, місяць, день) для номера дня від 1970-01-01
+inline void civilFromDays(std::int32_t days, int& year, int& month, int& day) {
+    days += 719468;
+    const int era = (days >= 0 ? days : days - 146096) / 146097;
+    const int dayOfEra = days - era * 146097;
+    const int yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    const int dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    const int shiftedMonth = (5 * dayOfYear + 2) / 153;
+    day = dayOfYear - (153 * shiftedMonth + 2) / 5 + 1;
+    month = shiftedMonth < 10 ? shiftedMonth + 3 : shiftedMonth - 9;
+    year = yearOfEra + era * 400 + (month <= 2);
+}
+
+// Перетворює номер дня на std::tm (лише дата)
+inline std::tm tmFromDay(std::int32_t days) {
+    std::tm date = {};
+    int year, month, day;
+    civilFromDays(days, year, month, day);
+    date.tm_year = year - 1900;
+    date.tm_mon = month - 1;
+    date.tm_mday = day;
+    return date;
+}
+
+// Записує номер дня як "YYYY-MM-DD" у буфер (щонайменше 32 символи), повертає довжину
+inline int formatDay(std::int32_t days, char* out) {
+    int year, month, day;
+    civilFromDays(days, year, month, day);
+    if (year < 0 || year > 9999) {
+        return std::snprintf(out, 32, "%d-%02d-%02d", year, month, day);
+    }
+    out[0] = static_cast<char>('0' + year / 1000);
+    out[1] = static_cast<char>('0' + year / 100 % 10);
+    out[2] = static_cast<char>('0' + year / 10 % 10);
+    out[3] = static_cast<char>('0' + year % 10);
+    out[4] = '-';
+    out[5] = static_cast<char>('0' + month / 10);
+    out[6] = static_cast<char>('0' + month % 10);
+    out[7] = '-';
+    out[8] = static_cast<char>('0' + day / 10);
+    out[9] = static_cast<char>('0' + day % 10);
+    out[10] = '\0';
+    return 10;
+}
+
+// Рядок завдання; пам'ять для нього може надходити з арени TaskMananger
+using TaskString = std::pmr::string;
+
+// Тип завдання. Новий тип потребує рядка в taskKinds, класу з staticKind і getPriority у TaskClassSlot,
+// гілки у visitTask та у TaskArena::create
+enum class TaskKind : std::uint8_t {
+    Normal,
+    Important  // Останнє значення: новий тип додається після нього, і перевірки нижче це помітять
+};
+
+// Властивості типу завдання, спільні для розбору, збереження та звітів
+struct TaskKindInfo {
+    std::string_view name;  // Назва типу у файлах і звітах
+    bool hasPriority;       // Чи має завдання пріоритет (поле у файлі та індекс терміновості)
+};
+
+// Властивості за значенням TaskKind
+constexpr TaskKindInfo taskKinds[] = {
+    {"Normal", false},
+    {"Important", true},
+};
+constexpr std::size_t taskKindCount = sizeof(taskKinds) / sizeof(taskKinds[0]);
+static_assert(taskKindCount == static_cast<std::size_t>(TaskKind::Important) + 1, "taskKinds must have a row for every TaskKind");
+static_assert(taskKindCount <= 32, "kind masks hold one bit per task kind");
+
+// Маска типів з пріоритетом (біт на значення TaskKind)
+constexpr std::uint32_t priorityKindMask() {
+    std::uint32_t mask = 0;
+    for (std::size_t i = 0; i < taskKindCount; ++i) {
+        mask |= static_cast<std::uint32_t>(taskKinds[i].hasPriority) << i;
+    }
+    return mask;
+}
+
+constexpr const TaskKindInfo& kindInfo(TaskKind kind) { return taskKinds[static_cast<std::size_t>(kind)]; }
+
+// Шукає тип за назвою; повертає false, якщо такого типу немає
+inline bool parseTaskKind(std::string_view name, TaskKind& kind) {
+    for (std::size_t i = 0; i < taskKindCount; ++i) {
+        if (taskKinds[i].name == name) {
+            kind = static_cast<TaskKind>(i);
+            return true;
+        }
+    }
+    return false;
+}
 
 // Базовий клас Task, який представляє загальне завдання
 class Task {
 protected:
-    std::string taskName;   // Назва завдання
-    std::string description;  // Опис завдання
-    std::tm deadline;    // Термін виконання завдання
+    TaskString taskName;   // Назва завдання
+    TaskString description;  // Опис завдання
+    std::int32_t deadlineDay = 0;  // Термін виконання: номер дня від 1970-01-01, обчислюється один раз
+    std::uint8_t deadlineLength = 0;  // Довжина кешованого рядка дати (0 — дедлайн не встановлено)
+    char deadlineText[15];  // Кешований рядок дати "YYYY-MM-DD"
+    TaskKind taskKind;      // Тип завдання для статичного вибору через visitTask
 
 public:
     // Конструктор за замовчуванням
     Task();
     
-    // Параметризований конструктор, який приймає назву, опис і дедлайн
-    Task(std::string _taskName, std::string _description, std::tm _deadline);
+    // Параметризований конструктор, який приймає назву, опис і дедлайн (рядки переміщуються без копіювання)
+    Task(TaskString _taskName, TaskString _description, std::tm _deadline, TaskKind _kind = TaskKind::Normal);
+    
+    // Конструктор з дедлайном як номером дня від 1970-01-01 (без перетворень через std::tm)
+    Task(TaskString _taskName, TaskString _description, std::int32_t _deadlineDay, TaskKind _kind = TaskKind::Normal);
     
     // Віртуальний деструктор (може бути перевизначений у похідних класах)
     virtual ~Task() {}
@@ -31,37 +374,69 @@ public:
     virtual std::string getImportance() const = 0;
     
     // Повертає назву завдання
-    std::string& getName() { return taskName; }
+    TaskString& getName() { return taskName; }
+    const TaskString& getName() const { return taskName; }
     
     // Повертає опис завдання
-    std::string& getDescription() { return description; }
+    TaskString& getDescription() { return description; }
+    const TaskString& getDescription() const { return description; }
     
     // Повертає термін виконання у вигляді рядка
     std::string getDeadlineString() const;
     
-    // Повертає термін виконання як std::tm об'єкт
-    std::tm& getDeadline() { return deadline; }
+    // Повертає кешований рядок дедлайну без виділення пам'яті (порожній, якщо дедлайн не встановлено)
+    std::string_view getDeadlineText() const { return std::string_view(deadlineText, deadlineLength); }
+    
+    // Повертає термін виконання як std::tm об'єкт (лише дата)
+    std::tm getDeadline() const { return tmFromDay(deadlineDay); }
+    
+    // Повертає термін виконання як номер дня від 1970-01-01
+    std::int32_t getDeadlineDay() const { return deadlineDay; }
+    
+    // Повертає тип завдання (без віртуального виклику)
+    TaskKind kind() const { return taskKind; }
+    
+    // Повертає пріоритет (0 для типів без пріоритету) без RTTI та віртуальних викликів
+    int priority() const;
 
     // Дружній оператор для виведення завдання у потік
     friend std::ostream& operator<<(std::ostream& os, const Task& obj);
+
+private:
+    friend class TaskMananger;
+    friend class TaskArena;
+    std::pmr::list<Task*>::iterator position;  // Позиція завдання у списку TaskMananger
+    std::uint64_t id = 0;                 // Порядковий номер завдання у TaskMananger
+    std::uint32_t row = 0;                // Рядок завдання у стовпчиковому сховищі
+    Task* nextSameName = nullptr;         // Наступне за віком завдання з тією ж назвою (ланцюжок індексу назв)
+    bool pooled = false;                  // Чи створено завдання в арені TaskArena
+    bool removing = false;                // Позначене для пакетного видалення
 };
 
 // Реалізація Task
-Task::Task() : taskName("Unknown"), description("Unknown") {}
+Task::Task() : taskName("Unknown"), description("Unknown"), taskKind(TaskKind::Normal) {}
 
 // Параметризований конструктор Task
-Task::Task(std::string _taskName, std::string _description, std::tm _deadline)
-    : taskName(_taskName), description(_description), deadline(_deadline) {}
+// Поля std::tm, що виходять за межі місяця, нормалізуються тут один раз, як це робив mktime
+Task::Task(TaskString _taskName, TaskString _description, std::tm _deadline, TaskKind _kind)
+    : Task(std::move(_taskName), std::move(_description), dayNumber(_deadline), _kind) {}
+
+// Конструктор з номером дня: рядок дати форматується одразу і далі лише читається
+Task::Task(TaskString _taskName, TaskString _description, std::int32_t _deadlineDay, TaskKind _kind)
+    : taskName(std::move(_taskName)), description(std::move(_description)), deadlineDay(_deadlineDay), taskKind(_kind) {
+    char buffer[32];
+    int length = formatDay(deadlineDay, buffer);
+    length = std::min(length, static_cast<int>(sizeof(deadlineText)));
+    std::memcpy(deadlineText, buffer, static_cast<std::size_t>(length));
+    deadlineLength = static_cast<std::uint8_t>(length);
+}
 
 // Метод для отримання дедлайну як рядка
 std::string Task::getDeadlineString() const {
-    if (mktime(const_cast<std::tm*>(&deadline)) != -1) {
-        char buffer[80];
-        strftime(buffer, 80, "%Y-%m-%d", &deadline);  // Форматування дати в рядок
-        return std::string(buffer);
-    } else {
+    if (deadlineLength == 0) {
         return "Deadline: Not Set";  // Якщо дедлайн не встановлено
     }
+    return std::string(getDeadlineText());
 }
 
 // Метод для виведення інформації про завдання
@@ -74,16 +449,22 @@ std::ostream& operator<<(std::ostream& os, const Task& obj) {
     os << std::left;
     os << std::setw(30) << obj.taskName    // Назва завдання
        << std::setw(50) << obj.description  // Опис завдання
-       << obj.getDeadlineString() << "\n";  // Термін виконання
+       << (obj.deadlineLength ? obj.getDeadlineText() : std::string_view("Deadline: Not Set")) << "\n";  // Термін виконання
     return os;
 }
 
 // Похідний клас NormalTask (звичайне завдання)
 class NormalTask : public Task {
 public:
+    static constexpr TaskKind staticKind = TaskKind::Normal;
+
     // Конструктор NormalTask, що викликає базовий конструктор Task
-    NormalTask(std::string _taskName, std::string _description, std::tm _deadline)
-        : Task(_taskName, _description, _deadline) {}
+    NormalTask(TaskString _taskName, TaskString _description, std::tm _deadline)
+        : Task(std::move(_taskName), std::move(_description), _deadline) {}
+
+    // Конструктор NormalTask з дедлайном як номером дня
+    NormalTask(TaskString _taskName, TaskString _description, std::int32_t _deadlineDay)
+        : Task(std::move(_taskName), std::move(_description), _deadlineDay) {}
 
     // Перевизначення методу для виведення інформації про звичайне завдання
     void printTask() const override {
@@ -95,6 +476,9 @@ public:
     std::string getImportance() const override {
         return "Not Important";  // Важливість для звичайного завдання
     }
+
+    // Звичайні завдання не мають пріоритету
+    int getPriority() const { return 0; }
 };
 
 // Похідний клас ImportantTask (важливе завдання)
@@ -102,9 +486,15 @@ class ImportantTask : public Task {
     int priority;  // Пріоритет важливого завдання (1-10)
 
 public:
+    static constexpr TaskKind staticKind = TaskKind::Important;
+
     // Конструктор ImportantTask, що викликає базовий конструктор Task та ініціалізує пріоритет
-    ImportantTask(std::string _taskName, std::string _description, std::tm _deadline, int _priority)
-        : Task(_taskName, _description, _deadline), priority(_priority) {}
+    ImportantTask(TaskString _taskName, TaskString _description, std::tm _deadline, int _priority)
+        : Task(std::move(_taskName), std::move(_description), _deadline, staticKind), priority(_priority) {}
+
+    // Конструктор ImportantTask з дедлайном як номером дня
+    ImportantTask(TaskString _taskName, TaskString _description, std::int32_t _deadlineDay, int _priority)
+        : Task(std::move(_taskName), std::move(_description), _deadlineDay, staticKind), priority(_priority) {}
 
     // Перевизначення методу для виведення інформації про важливе завдання
     void printTask() const override {
@@ -116,429 +506,5104 @@ public:
     std::string getImportance() const override {
         return std::to_string(priority);  // Важливість повертається як пріоритет
     }
+
+    // Повертає пріоритет як число
+    int getPriority() const { return priority; }
 };
 
+// Викликає visitor із завданням його справжнього типу, вибраного за kind() без RTTI;
+// код visitor компілюється окремо для кожного типу
+template <typename Visitor>
+decltype(auto) visitTask(const Task& task, Visitor&& visitor) {
+    switch (task.kind()) {  // Без default: -Wswitch повідомить про тип без гілки
+        case TaskKind::Normal:
+            return visitor(static_cast<const NormalTask&>(task));
+        case TaskKind::Important:
+            return visitor(static_cast<const ImportantTask&>(task));
+    }
+    std::abort();  // Значення поза TaskKind буває лише у пошкодженому завданні
+}
 
-// Клас для управління завданнями
-class TaskMananger {
-    std::list<Task*> tasks;  // Список вказівників на об'єкти завдань
+// Комірка, в яку вміщується завдання будь-якого з класів; класи перелічуються в порядку TaskKind
+template <typename... Classes>
+struct TaskSlot {
+    static constexpr std::size_t size = std::max({sizeof(Classes)...});
+    static constexpr std::size_t align = std::max({alignof(Classes)...});
 
-public:
-    ~TaskMananger();  // Деструктор для очищення пам'яті
+    // Чи йдуть класи у порядку значень TaskKind і чи є клас для кожного типу
+    static constexpr bool coversKinds() {
+        std::size_t index = 0;
+        return sizeof...(Classes) == taskKindCount && ((Classes::staticKind == static_cast<TaskKind>(index++)) && ...);
+    }
+};
+using TaskClassSlot = TaskSlot<NormalTask, ImportantTask>;
+static_assert(TaskClassSlot::coversKinds(), "TaskClassSlot must list one class per TaskKind in order");
+
+inline int Task::priority() const {
+    return visitTask(*this, [](const auto& task) { return task.getPriority(); });
+}
+
+// Формат виведення списку завдань
+enum class ReportFormat {
+    Table,     // Вирівняні стовпці для читання людиною
+    Csv,       // Значення через кому (RFC 4180)
+    Tsv,       // Значення через табуляцію
+    JsonLines  // Один JSON-об'єкт на рядок
+};
+
+// Розбирає назву формату звіту (table, csv, tsv, jsonl); повертає false для невідомої назви
+inline bool parseReportFormat(std::string_view name, ReportFormat& format) {
+    if (name == "table") {
+        format = ReportFormat::Table;
+    } else if (name == "csv") {
+        format = ReportFormat::Csv;
+    } else if (name == "tsv") {
+        format = ReportFormat::Tsv;
+    } else if (name == "jsonl") {
+        format = ReportFormat::JsonLines;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Формує рядки звіту у великому буфері та записує його у файловий дескриптор великими блоками
+class ReportWriter {
+    static constexpr std::size_t bufferSize = 1 << 20;  // Розмір буфера (1 МіБ)
+
+    int fd;                          // Куди записувати
+    ReportFormat format;             // Формат рядків
+    std::unique_ptr<char[]> buffer;  // Буфер, що використовується повторно
+    std::size_t used = 0;            // Зайнято в буфері
+    bool failed = false;             // Чи сталася помилка запису
+
+    // Гарантує місце для count символів у буфері
+    void reserve(std::size_t count) {
+        if (bufferSize - used < count) {
+            flush();
+        }
+    }
 
-    // Додає нове завдання
-    void addTask(Task* task);
+    // Додає текст (довгий текст записується частинами)
+    void append(std::string_view text);
+    void append(char c) {
+        reserve(1);
+        buffer[used++] = c;
+    }
     
-    // Видаляє завдання за його назвою
-    bool deleteTask(const std::string& taskName);
+    // Додає текст, доповнений пробілами до ширини width (як std::setw з std::left)
+    void appendPadded(std::string_view text, std::size_t width);
     
-    // Виводить усі завдання
-    void printTasks() const;
+    // Додає рядок у лапках для CSV/JSON або з екрануванням для TSV
+    void appendQuoted(std::string_view text);
     
-    // Фільтрує завдання за дедлайном
-    void filterTasksByDeadline(const std::tm& deadline) const;
+    // Додає ціле число
+    void appendNumber(int value);
+
+public:
+    ReportWriter(int fd, ReportFormat format);
+    ~ReportWriter() { flush(); }
+
+    ReportWriter(const ReportWriter&) = delete;
+    ReportWriter& operator=(const ReportWriter&) = delete;
+
+    // Записує заголовок (для таблиці, CSV та TSV)
+    void writeHeader();
     
-    // Зберігає завдання у файл
-    void saveToFile(const std::string& fileName) const;
+    // Записує рядок про одне завдання
+    void writeRow(TaskKind kind, int priority, std::int32_t deadlineDay, std::string_view name, std::string_view description);
     
-    // Завантажує завдання з файлу
-    void loadFromFile(const std::string& fileName);
+    // Записує довільний текст (лише для таблиці)
+    void writeText(std::string_view text);
     
-    // Сортує завдання за важливістю
-    void sortByImportance();
+    // Записує вміст буфера у дескриптор
+    void flush();
+    
+    // Чи всі дані записано успішно
+    bool good() const { return !failed; }
 };
 
-// Деструктор очищує пам'ять від завдань
-TaskMananger::~TaskMananger() {
-    for (Task* task : tasks) {
-        delete task;  // Очищаємо пам'ять для кожного завдання
+ReportWriter::ReportWriter(int fd, ReportFormat format) : fd(fd), format(format), buffer(new char[bufferSize]) {
+    if (fd == STDOUT_FILENO) {
+        std::cout.flush();  // Попередній вивід через std::cout має з'явитися раніше за звіт
     }
 }
 
-// Додає нове завдання до списку
-void TaskMananger::addTask(Task* task) {
-    tasks.push_back(task);  // Додаємо завдання до кінця списку
+void ReportWriter::append(std::string_view text) {
+    while (!text.empty()) {
+        reserve(1);
+        std::size_t count = std::min(text.size(), bufferSize - used);
+        std::memcpy(buffer.get() + used, text.data(), count);
+        used += count;
+        text.remove_prefix(count);
+    }
 }
 
-// Видаляє завдання за його назвою
-bool TaskMananger::deleteTask(const std::string& taskName) {
-    for (auto it = tasks.begin(); it != tasks.end(); ++it) {
-        if ((*it)->getName() == taskName) {  // Якщо знайшли завдання з відповідною назвою
-            delete *it;  // Видаляємо об'єкт
-            tasks.erase(it);  // Видаляємо вказівник із списку
-            return true;
-        }
+void ReportWriter::appendPadded(std::string_view text, std::size_t width) {
+    append(text);
+    if (text.size() < width) {
+        std::size_t padding = width - text.size();
+        reserve(padding);
+        std::memset(buffer.get() + used, ' ', padding);
+        used += padding;
     }
-    return false;  // Повертаємо false, якщо завдання не знайдено
 }
 
-// Виводить усі завдання на екран
-void TaskMananger::printTasks() const {
-    if (tasks.empty()) {
-        std::cout << "There are no tasks.\n";  // Якщо немає завдань
-    } else {
-        std::cout << std::left;
-        // Додаємо заголовки стовпців
-        std::cout << std::setw(30) << "Task Name" 
-                  << std::setw(50) << "Description" 
-                  << std::setw(20) << "Deadline" 
-                  << "Importance" << "\n";
-        std::cout << std::string(110, '-') << "\n";  // Роздільна лінія
-
-        // Виводимо інформацію про кожне завдання
-        for (Task* task : tasks) {
-            std::cout << std::setw(30) << task->getName()
-                      << std::setw(50) << task->getDescription()
-                      << std::setw(20) << task->getDeadlineString()
-                      << task->getImportance() << "\n";  // Виводимо важливість завдання
-        }
+void ReportWriter::appendQuoted(std::string_view text) {
+    switch (format) {
+        case ReportFormat::Csv:
+            if (text.find_first_of(",\"\n\r") == std::string_view::npos) {
+                append(text);
+                return;
+            }
+            append('"');
+            for (char c : text) {
+                if (c == '"') {
+                    append('"');  // Лапки подвоюються
+                }
+                append(c);
+            }
+            append('"');
+            return;
+        case ReportFormat::Tsv:
+            for (char c : text) {
+                switch (c) {
+                    case '\t': append("\\t"); break;
+                    case '\n': append("\\n"); break;
+                    case '\r': append("\\r"); break;
+                    case '\\': append("\\\\"); break;
+                    default: append(c);
+                }
+            }
+            return;
+        case ReportFormat::JsonLines:
+            append('"');
+            for (char c : text) {
+                switch (c) {
+                    case '"': append("\\\""); break;
+                    case '\\': append("\\\\"); break;
+                    case '\n': append("\\n"); break;
+                    case '\r': append("\\r"); break;
+                    case '\t': append("\\t"); break;
+                    default:
+                        if (static_cast<unsigned char>(c) < 0x20) {
+                            static const char hex[] = "0123456789abcdef";
+                            append("\\u00");
+                            append(hex[(c >> 4) & 0xF]);
+                            append(hex[c & 0xF]);
+                        } else {
+                            append(c);
+                        }
+                }
+            }
+            append('"');
+            return;
+        case ReportFormat::Table:
+            append(text);
+            return;
     }
 }
 
-// Фільтрує завдання за дедлайном (ті, що мають дедлайн після заданої дати)
-void TaskMananger::filterTasksByDeadline(const std::tm& deadline) const {
-    if (tasks.empty()) {
-        std::cout << "There are no tasks.\n";  // Якщо немає завдань
-    } else {
-        bool found = false;  // Прапорець, що вказує, чи були знайдені завдання
+void ReportWriter::appendNumber(int value) {
+    char digits[16];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    append(std::string_view(digits, static_cast<std::size_t>(result.ptr - digits)));
+}
 
-        std::cout << std::left;
-        // Виводимо заголовок фільтрованих завдань
-        std::cout << "Filtered Tasks (on or after " << std::put_time(&deadline, "%Y-%m-%d") << "):\n";
-        std::cout << std::setw(30) << "Task Name" << std::setw(50) << "Description" << "Deadline" << "\n";
-        std::cout << std::string(100, '-') << "\n";  // Роздільна лінія
+void ReportWriter::writeHeader() {
+    switch (format) {
+        case ReportFormat::Table:
+            appendPadded("Task Name", 30);
+            appendPadded("Description", 50);
+            appendPadded("Deadline", 20);
+            append("Importance\n");
+            append(std::string(110, '-'));  // Роздільна лінія
+            append('\n');
+            break;
+        case ReportFormat::Csv:
+            append("type,name,description,deadline,priority\n");
+            break;
+        case ReportFormat::Tsv:
+            append("type\tname\tdescription\tdeadline\tpriority\n");
+            break;
+        case ReportFormat::JsonLines:
+            break;  // Кожен рядок JSON описує себе сам
+    }
+}
 
-        for (Task* task : tasks) {
-            if (mktime(&task->getDeadline()) >= mktime(const_cast<std::tm*>(&deadline))) {
-                task->printTask();  // Якщо дедлайн завдання підходить, виводимо його
-                found = true;  // Знайшли завдання
-            }
-        }
+void ReportWriter::writeRow(TaskKind kind, int priority, std::int32_t deadlineDay, std::string_view name, std::string_view description) {
+    char date[32];
+    std::string_view dateText(date, static_cast<std::size_t>(formatDay(deadlineDay, date)));
+    const TaskKindInfo& info = kindInfo(kind);
+    std::string_view typeText = info.name;
 
-        if (!found) {
-            std::cout << "No tasks found with a deadline on or after the specified date.\n";  // Якщо не знайдено жодного
+    switch (format) {
+        case ReportFormat::Table:
+            appendPadded(name, 30);
+            appendPadded(description, 50);
+            appendPadded(dateText, 20);
+            if (info.hasPriority) {
+                appendNumber(priority);
+            } else {
+                append("Not Important");
+            }
+            append('\n');
+            break;
+        case ReportFormat::Csv:
+        case ReportFormat::Tsv: {
+            char separator = format == ReportFormat::Csv ? ',' : '\t';
+            append(typeText);
+            append(separator);
+            appendQuoted(name);
+            append(separator);
+            appendQuoted(description);
+            append(separator);
+            append(dateText);
+            append(separator);
+            if (info.hasPriority) {
+                appendNumber(priority);
+            }
+            append('\n');
+            break;
         }
+        case ReportFormat::JsonLines:
+            append("{\"type\":\"");
+            append(typeText);
+            append("\",\"name\":");
+            appendQuoted(name);
+            append(",\"description\":");
+            appendQuoted(description);
+            append(",\"deadline\":\"");
+            append(dateText);
+            append('"');
+            if (info.hasPriority) {
+                append(",\"priority\":");
+                appendNumber(priority);
+            }
+            append("}\n");
+            break;
     }
 }
 
-// Зберігає завдання до файлу
-void TaskMananger::saveToFile(const std::string& fileName) const {
-    try {
-        std::ofstream file(fileName, std::ios::out);  // Відкриваємо файл для запису
+void ReportWriter::writeText(std::string_view text) {
+    if (format == ReportFormat::Table) {
+        append(text);
+    }
+}
 
-        if (!file.is_open()) {
-            throw std::runtime_error("Error: can't open file for writing");
+void ReportWriter::flush() {
+    std::size_t done = 0;
+    while (done < used && !failed) {
+        ssize_t written = ::write(fd, buffer.get() + done, used - done);
+        if (written < 0 && errno == EINTR) {
+            continue;
         }
-
-        // Записуємо кожне завдання до файлу
-        for (Task* task : tasks) {
-            char buffer[80];
-            strftime(buffer, 80, "%Y-%m-%d", &task->getDeadline());  // Форматуємо дату
-
-            ImportantTask* importantTask = dynamic_cast<ImportantTask*>(task);  // Перевіряємо чи це важливе завдання
-            if (importantTask) {
-                // Записуємо важливе завдання до файлу
-                file << "Important|"
-                     << task->getName() << "|" 
-                     << task->getDescription() << "|" 
-                     << buffer << "|" 
-                     << importantTask->getImportance() << "\n";
-            } else {
-                // Записуємо звичайне завдання до файлу
-                file << "Normal|"
-                     << task->getName() << "|" 
-                     << task->getDescription() << "|" 
-                     << buffer << "\n";
-            }
+        if (written <= 0) {
+            failed = true;
+            break;
         }
-
-        std::cout << "Successfully saved to file\n";
-        file.close();  // Закриваємо файл
-    } catch (const std::exception& e) {
-        std::cerr << "Error occurred during file saving: " << e.what() << "\n";  // Якщо сталася помилка
+        done += static_cast<std::size_t>(written);
     }
+    used = 0;
 }
 
-// Завантажує завдання з файлу
-void TaskMananger::loadFromFile(const std::string& fileName) {
-    try {
-        std::ifstream file(fileName, std::ios::in);  // Відкриваємо файл для читання
+// Умова вибірки завдань зі стовпчикового сховища
+struct TaskFilter {
+    std::int32_t fromDay = std::numeric_limits<std::int32_t>::min();  // Дедлайн не раніше (номер дня)
+    std::int32_t toDay = std::numeric_limits<std::int32_t>::max();    // Дедлайн не пізніше (номер дня)
+    int minPriority = std::numeric_limits<int>::min();                // Пріоритет не менше
+    int maxPriority = std::numeric_limits<int>::max();                // Пріоритет не більше
 
-        if (!file.is_open()) {
-            throw std::runtime_error("Error: can't open file for reading");
-        }
+    // Типи, що можуть задовольнити умову: межа пріоритету відбирає лише типи з пріоритетом
+    std::uint32_t kindMask() const {
+        bool priorityBound = minPriority != std::numeric_limits<int>::min() || maxPriority != std::numeric_limits<int>::max();
+        return priorityBound ? priorityKindMask() : (std::uint32_t(1) << taskKindCount) - 1;
+    }
 
-        std::string line;
-        while (std::getline(file, line)) {
-            std::istringstream iss(line);
-            std::string taskType, name, description, deadlineStr, importanceStr;
+    // Чи задовольняє умову завдання такого типу з таким пріоритетом і дедлайном
+    bool matches(TaskKind kind, int priority, std::int32_t deadlineDay) const {
+        return ((kindMask() >> static_cast<unsigned>(kind)) & 1) && deadlineDay >= fromDay && deadlineDay <= toDay &&
+               priority >= minPriority && priority <= maxPriority;
+    }
+};
 
-            // Читаємо тип завдання (Normal або Important)
-            if (std::getline(iss, taskType, '|') && 
-                std::getline(iss, name, '|') && 
-                std::getline(iss, description, '|') && 
-                std::getline(iss, deadlineStr, '|')) {
+// Стовпчики сховища, які переглядають ядра фільтрації
+struct ScanColumns {
+    const std::uint8_t* kinds;          // Тип завдання або позначка видаленого рядка
+    const std::int32_t* priorities;     // Пріоритети
+    const std::int32_t* deadlineDays;   // Номери днів дедлайнів
+    std::size_t rows;                   // Кількість рядків
+};
 
-                std::tm deadline = {};
-                if (strptime(deadlineStr.c_str(), "%Y-%m-%d", &deadline)) {
-                    if (taskType == "Important") {
-                        // Якщо це важливе завдання, читаємо його пріоритет
-                        if (std::getline(iss, importanceStr, '|')) {
-                            int priority = std::stoi(importanceStr);  // Конвертуємо пріоритет у число
-                            addTask(new ImportantTask(name, description, deadline, priority));  // Додаємо важливе завдання
-                        }
-                    } else {
-                        // Якщо це NormalTask
-                        addTask(new NormalTask(name, description, deadline));  // Додаємо звичайне завдання
-                    }
-                } else {
-                    std::cerr << "Error parsing date: " << deadlineStr << "\n";  // Якщо помилка при розборі дати
-                }
-            }
+// Ядро фільтрації: записує у bitmap ((rows + 63) / 64 слів) біт кожного живого рядка, що задовольняє умову
+using ScanKernel = void (*)(const ScanColumns& columns, const TaskFilter& filter, std::uint64_t* bitmap);
+
+constexpr std::uint8_t removedRowKind = 0xFF;  // Позначка видаленого рядка у стовпчику типів
+
+// Скалярне ядро для рядків від first (кратного 64) до кінця; також дописує хвости векторних ядер
+inline void scanRowsScalar(const ScanColumns& columns, const TaskFilter& filter, std::uint64_t* bitmap, std::size_t first) {
+    const std::uint32_t kindMask = filter.kindMask();  // Видалені рядки (removedRowKind) не входять у маску
+    for (std::size_t start = first; start < columns.rows; start += 64) {
+        std::size_t end = std::min(columns.rows, start + 64);
+        std::uint64_t word = 0;
+        for (std::size_t row = start; row < end; ++row) {
+            const unsigned kind = columns.kinds[row];
+            const std::int32_t day = columns.deadlineDays[row];
+            const int priority = columns.priorities[row];
+            // Побітове & замість && — без розгалужень, які процесор не вгадає на випадкових даних
+            bool match = (kind < 32) & ((kindMask >> (kind & 31)) & 1) & (day >= filter.fromDay) & (day <= filter.toDay) &
+                         (priority >= filter.minPriority) & (priority <= filter.maxPriority);
+            word |= static_cast<std::uint64_t>(match) << (row - start);
         }
+        bitmap[start / 64] = word;
+    }
+}
 
-        std::cout << "Successfully loaded from file\n";
-        file.close();  // Закриваємо файл
-    } catch (const std::exception& e) {
-        std::cerr << "Error occurred during file loading: " << e.what() << "\n";  // Якщо сталася помилка
+inline void scanScalar(const ScanColumns& columns, const TaskFilter& filter, std::uint64_t* bitmap) {
+    scanRowsScalar(columns, filter, bitmap, 0);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// SSE4.1: 4 рядки за порівняння. Умова перевертається в "відкинути": from > day, day > to, min > priority,
+// priority > max або тип не з маски — так межі на краях діапазону int32 не переповнюються.
+// Тип порівнюється з кожним дозволеним значенням; замість недозволеного — -1, якого немає у стовпчику
+__attribute__((target("sse4.1")))
+inline void scanSse41(const ScanColumns& columns, const TaskFilter& filter, std::uint64_t* bitmap) {
+    const __m128i fromDay = _mm_set1_epi32(filter.fromDay);
+    const __m128i toDay = _mm_set1_epi32(filter.toDay);
+    const __m128i minPriority = _mm_set1_epi32(filter.minPriority);
+    const __m128i maxPriority = _mm_set1_epi32(filter.maxPriority);
+    __m128i allowedKinds[taskKindCount];
+    for (std::size_t kind = 0; kind < taskKindCount; ++kind) {
+        allowedKinds[kind] = _mm_set1_epi32((filter.kindMask() >> kind) & 1 ? static_cast<int>(kind) : -1);
+    }
+    const std::size_t blocks = columns.rows / 64;
+    for (std::size_t block = 0; block < blocks; ++block) {
+        std::uint64_t word = 0;
+        for (std::size_t part = 0; part < 16; ++part) {
+            const std::size_t row = block * 64 + part * 4;
+            std::int32_t kindBytes;
+            std::memcpy(&kindBytes, columns.kinds + row, sizeof(kindBytes));
+            __m128i days = _mm_loadu_si128(reinterpret_cast<const __m128i*>(columns.deadlineDays + row));
+            __m128i priorities = _mm_loadu_si128(reinterpret_cast<const __m128i*>(columns.priorities + row));
+            __m128i kinds = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(kindBytes));
+            __m128i reject = _mm_or_si128(_mm_cmpgt_epi32(fromDay, days), _mm_cmpgt_epi32(days, toDay));
+            reject = _mm_or_si128(reject, _mm_or_si128(_mm_cmpgt_epi32(minPriority, priorities), _mm_cmpgt_epi32(priorities, maxPriority)));
+            __m128i allowed = _mm_setzero_si128();
+            for (const __m128i& kind : allowedKinds) {
+                allowed = _mm_or_si128(allowed, _mm_cmpeq_epi32(kinds, kind));
+            }
+            std::uint64_t mask = static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(_mm_andnot_si128(reject, allowed))));
+            word |= mask << (part * 4);
+        }
+        bitmap[block] = word;
     }
+    scanRowsScalar(columns, filter, bitmap, blocks * 64);
 }
 
-// Сортує завдання за важливістю
-void TaskMananger::sortByImportance() {
-    tasks.sort([](Task* a, Task* b) {
-        // Перевіряємо, чи завдання є важливими
-        ImportantTask* importantA = dynamic_cast<ImportantTask*>(a);
-        ImportantTask* importantB = dynamic_cast<ImportantTask*>(b);
-
-        if (importantA && importantB) {
-            // Порівнюємо пріоритети важливих завдань
-            int priorityA = std::stoi(importantA->getImportance());
-            int priorityB = std::stoi(importantB->getImportance());
-            return priorityA > priorityB;  // Більший пріоритет "вище"
-        } else if (importantA) {
-            // Якщо лише A важливе
-            return true;
-        } else if (importantB) {
-            // Якщо лише B важливе
-            return false;
-        } else {
-            // Якщо обидва завдання NormalTask
-            return false;
+// AVX2: 8 рядків за порівняння, те саме перевернуте порівняння
+__attribute__((target("avx2")))
+inline void scanAvx2(const ScanColumns& columns, const TaskFilter& filter, std::uint64_t* bitmap) {
+    const __m256i fromDay = _mm256_set1_epi32(filter.fromDay);
+    const __m256i toDay = _mm256_set1_epi32(filter.toDay);
+    const __m256i minPriority = _mm256_set1_epi32(filter.minPriority);
+    const __m256i maxPriority = _mm256_set1_epi32(filter.maxPriority);
+    __m256i allowedKinds[taskKindCount];
+    for (std::size_t kind = 0; kind < taskKindCount; ++kind) {
+        allowedKinds[kind] = _mm256_set1_epi32((filter.kindMask() >> kind) & 1 ? static_cast<int>(kind) : -1);
+    }
+    const std::size_t blocks = columns.rows / 64;
+    for (std::size_t block = 0; block < blocks; ++block) {
+        std::uint64_t word = 0;
+        for (std::size_t part = 0; part < 8; ++part) {
+            const std::size_t row = block * 64 + part * 8;
+            __m256i days = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(columns.deadlineDays + row));
+            __m256i priorities = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(columns.priorities + row));
+            __m256i kinds = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(columns.kinds + row)));
+            __m256i reject = _mm256_or_si256(_mm256_cmpgt_epi32(fromDay, days), _mm256_cmpgt_epi32(days, toDay));
+            reject = _mm256_or_si256(reject, _mm256_or_si256(_mm256_cmpgt_epi32(minPriority, priorities), _mm256_cmpgt_epi32(priorities, maxPriority)));
+            __m256i allowed = _mm256_setzero_si256();
+            for (const __m256i& kind : allowedKinds) {
+                allowed = _mm256_or_si256(allowed, _mm256_cmpeq_epi32(kinds, kind));
+            }
+            std::uint64_t mask = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_andnot_si256(reject, allowed))));
+            word |= mask << (part * 8);
         }
-    });
+        bitmap[block] = word;
+    }
+    scanRowsScalar(columns, filter, bitmap, blocks * 64);
+}
+#endif
 
-    std::cout << "Tasks sorted by importance.\n";  // Повідомляємо, що сортування завершено
+// Ядра, які підтримує процесор, від скалярного до найшвидшого
+inline std::vector<std::pair<const char*, ScanKernel>> supportedScanKernels() {
+    std::vector<std::pair<const char*, ScanKernel>> kernels = {{"scalar", scanScalar}};
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();  // Може викликатися до статичних конструкторів бібліотеки
+    if (__builtin_cpu_supports("sse4.1")) {
+        kernels.emplace_back("sse4.1", scanSse41);
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        kernels.emplace_back("avx2", scanAvx2);
+    }
+#endif
+    return kernels;
 }
 
-// Клас для управління меню
-class Menu {
-    TaskMananger taskManager;  // Об'єкт менеджера завдань
+// Найшвидше доступне ядро; вибирається один раз під час запуску програми
+const ScanKernel bestScanKernel = supportedScanKernels().back().second;
 
+// Стовпчикове сховище завдань (struct-of-arrays): кожне поле лежить у власному неперервному масиві.
+// Порядок рядків збігається з порядком завдань у TaskMananger.
+// Рядки не копіюються: назва та опис читаються із завдання-власника, яке ними володіє.
+class TaskStore {
 public:
-    Menu() {}
+    static constexpr std::uint8_t removedKind = removedRowKind;  // Позначка видаленого рядка
 
-    void displayMenu();  // Відображає меню
-    void handleInput();  // Обробляє введення користувача
+private:
+    std::vector<std::uint8_t> kinds;          // Тип завдання (TaskKind) або removedKind
+    std::vector<std::int32_t> priorities;     // Пріоритет (0 для звичайних завдань)
+    std::vector<std::int32_t> deadlineDays;   // Номер дня дедлайну від 1970-01-01
+    std::vector<Task*> owners;                // Завдання, якому належить рядок (nullptr для видаленого)
+    std::size_t removed = 0;                  // Кількість видалених рядків
 
-    void addTask();      // Додає звичайне завдання
-    void deleteTask();   // Видаляє завдання
-    void printTasks();   // Виводить усі завдання
-    void filterTasks();  // Фільтрує завдання за дедлайном
-    void saveToFile();   // Зберігає завдання у файл
-    void loadFromFile(); // Завантажує завдання з файлу
+public:
+    // Додає рядок і повертає його номер
+    std::uint32_t append(TaskKind kind, int priority, std::int32_t deadlineDay, Task* owner);
+    
+    // Резервує місце для заданої кількості рядків
+    void reserve(std::size_t count);
+    
+    // Позначає рядок видаленим
+    void remove(std::uint32_t row);
+    
+    // Перебудовує сховище, лишаючи задані рядки у заданому порядку
+    void reorder(const std::vector<std::uint32_t>& order);
+    
+    // Чи варто ущільнити сховище (видалених рядків більше, ніж живих)
+    bool needsCompaction() const { return removed > 1024 && removed * 2 > kinds.size(); }
+    
+    // Повертає бітову карту живих рядків, що задовольняють умову (біт row % 64 слова row / 64)
+    std::vector<std::uint64_t> selectBitmap(const TaskFilter& filter, ScanKernel kernel = bestScanKernel) const;
+    
+    // Повертає номери живих рядків, що задовольняють умову
+    std::vector<std::uint32_t> select(const TaskFilter& filter) const;
+    
+    // Рахує живі рядки, що задовольняють умову
+    std::size_t count(const TaskFilter& filter) const;
+    
+    // Очищає сховище
+    void clear();
+
+    std::size_t rows() const { return kinds.size(); }
+    std::size_t size() const { return kinds.size() - removed; }
+    bool isRemoved(std::uint32_t row) const { return kinds[row] == removedKind; }
+    TaskKind kind(std::uint32_t row) const { return static_cast<TaskKind>(kinds[row]); }
+    int priority(std::uint32_t row) const { return priorities[row]; }
+    std::int32_t deadlineDay(std::uint32_t row) const { return deadlineDays[row]; }
+    std::string_view name(std::uint32_t row) const { return owners[row]->getName(); }  // Лише для живих рядків
+    std::string_view description(std::uint32_t row) const { return owners[row]->getDescription(); }
+    Task* owner(std::uint32_t row) const { return owners[row]; }
 };
 
-// Відображає меню користувачеві
-void Menu::displayMenu() {
-    std::cout << "\nTask Manager Menu:\n";
-    std::cout << "1. Add Normal Task\n";       // Додати звичайне завдання
-    std::cout << "2. Add Important Task\n";    // Додати важливе завдання
-    std::cout << "3. Delete Task\n";           // Видалити завдання
-    std::cout << "4. View All Tasks\n";        // Переглянути всі завдання
-    std::cout << "5. Filter Tasks by Deadline\n";  // Фільтрувати завдання за дедлайном
-    std::cout << "6. Sort Tasks by Importance\n";  // Сортувати завдання за важливістю
-    std::cout << "7. Save Tasks to File\n";    // Зберегти завдання у файл
-    std::cout << "8. Load Tasks from File\n";  // Завантажити завдання з файлу
-    std::cout << "9. Exit\n";                  // Вийти з програми
-    std::cout << "Enter your choice: ";        // Запитати вибір користувача
+std::uint32_t TaskStore::append(TaskKind kind, int priority, std::int32_t deadlineDay, Task* owner) {
+    if (kinds.size() >= std::numeric_limits<std::uint32_t>::max()) {
+        throw std::length_error("Error: too many tasks for 32-bit row numbers");
+    }
+    kinds.push_back(static_cast<std::uint8_t>(kind));
+    priorities.push_back(priority);
+    deadlineDays.push_back(deadlineDay);
+    owners.push_back(owner);
+    return static_cast<std::uint32_t>(kinds.size() - 1);
 }
 
-// Обробляє введення користувача та викликає відповідні функції
-void Menu::handleInput() {
-    int choice = 0;
+void TaskStore::reserve(std::size_t count) {
+    kinds.reserve(count);
+    priorities.reserve(count);
+    deadlineDays.reserve(count);
+    owners.reserve(count);
+}
+
+void TaskStore::remove(std::uint32_t row) {
+    kinds[row] = removedKind;
+    owners[row] = nullptr;
+    ++removed;
+}
+
+void TaskStore::reorder(const std::vector<std::uint32_t>& order) {
+    TaskStore result;
+    result.reserve(order.size());
+    for (std::uint32_t row : order) {
+        result.kinds.push_back(kinds[row]);
+        result.priorities.push_back(priorities[row]);
+        result.deadlineDays.push_back(deadlineDays[row]);
+        result.owners.push_back(owners[row]);
+    }
+    *this = std::move(result);
+}
+
+std::vector<std::uint64_t> TaskStore::selectBitmap(const TaskFilter& filter, ScanKernel kernel) const {
+    std::vector<std::uint64_t> bitmap((kinds.size() + 63) / 64);
+    kernel({kinds.data(), priorities.data(), deadlineDays.data(), kinds.size()}, filter, bitmap.data());
+    return bitmap;
+}
+
+std::vector<std::uint32_t> TaskStore::select(const TaskFilter& filter) const {
+    std::vector<std::uint64_t> bitmap = selectBitmap(filter);
+    std::size_t total = 0;
+    for (std::uint64_t word : bitmap) {
+        total += static_cast<std::size_t>(__builtin_popcountll(word));
+    }
+    std::vector<std::uint32_t> result;
+    result.reserve(total);
+    for (std::size_t i = 0; i < bitmap.size(); ++i) {
+        for (std::uint64_t word = bitmap[i]; word != 0; word &= word - 1) {
+            result.push_back(static_cast<std::uint32_t>(i * 64 + static_cast<std::size_t>(__builtin_ctzll(word))));
+        }
+    }
+    return result;
+}
+
+std::size_t TaskStore::count(const TaskFilter& filter) const {
+    std::size_t result = 0;
+    for (std::uint64_t word : selectBitmap(filter)) {
+        result += static_cast<std::size_t>(__builtin_popcountll(word));
+    }
+    return result;
+}
+
+void TaskStore::clear() {
+    *this = TaskStore();
+}
+
+
+// Відрізає від команди або запиту наступне слово (до пробілу)
+inline std::string_view nextWord(std::string_view& text) {
+    std::size_t start = text.find_first_not_of(' ');
+    if (start == std::string_view::npos) {
+        text = std::string_view();
+        return std::string_view();
+    }
+    text.remove_prefix(start);
+    std::size_t end = text.find(' ');
+    std::string_view word = text.substr(0, end);
+    text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+    return word;
+}
+
+// Інвертований індекс слів з назв та описів завдань: слово -> список завдань у порядку номерів.
+// Слово — послідовність латинських літер, цифр або байтів UTF-8; регістр латинських літер не враховується.
+class TextIndex {
+    struct Posting {
+        std::uint64_t id = 0;   // Номер завдання (списки впорядковані за зростанням номерів)
+        Task* task = nullptr;   // Завдання або nullptr, якщо його вже видалено
+    };
+
+    struct PostingList {
+        std::string word;              // Слово (ключ таблиці вказує на цей рядок)
+        std::vector<Posting> entries;  // Записи у порядку номерів (порожньо, якщо список вільний)
+        std::size_t removed = 0;       // Кількість видалених записів, що ще лишаються у списку
+    };
+
+    std::deque<PostingList> lists;            // Списки слів (елементи deque не переміщуються)
+    std::vector<std::uint32_t> freeLists;     // Номери звільнених списків для повторного використання
+    StringHashMap<std::uint32_t> postings;    // Номер списку для кожного слова
+    std::vector<std::uint32_t> vocabulary;    // Номери списків для пошуку за префіксом
+    bool vocabularySorted = true;             // Чи впорядкований словник за словами
+    std::string folded;                        // Буфер для тексту в нижньому регістрі
+    std::vector<std::string_view> scratch;     // Унікальні слова одного завдання
+
+    // Розбиває текст на слова в нижньому регістрі (результат у scratch, слова можуть повторюватися)
+    void tokenize(std::string_view first, std::string_view second);
+
+    // Збирає живі записи всіх слів, що починаються з prefix, у порядку номерів
+    void matchPrefix(std::string_view prefix, std::vector<Posting>& result);
+
+public:
+    // Додає слова завдання (номер має бути більшим за номери вже доданих завдань)
+    void add(std::uint64_t id, Task* task, std::string_view name, std::string_view description);
+    
+    // Прибирає слова завдання
+    void remove(std::uint64_t id, std::string_view name, std::string_view description);
+    
+    // Шукає завдання за запитом у порядку додавання:
+    //   слова через пробіл (або AND) мають бути всі, OR розділяє альтернативи, слово* — пошук за префіксом.
+    // Впорядковує словник за потреби, тому не є const
+    std::vector<Task*> search(std::string_view query);
+    
+    // Очищає індекс
+    void clear();
+    
+    std::size_t wordCount() const { return postings.size(); }
+};
+
+void TextIndex::tokenize(std::string_view first, std::string_view second) {
+    // Буфер заповнюється повністю до того, як на нього почнуть вказувати слова
+    folded.resize(first.size() + second.size() + 2);
+    char* out = &folded[0];
+    for (std::string_view text : {first, second}) {
+        for (char c : text) {
+            unsigned char byte = static_cast<unsigned char>(c);
+            if ((byte >= 'a' && byte <= 'z') || (byte >= '0' && byte <= '9') || byte >= 0x80) {
+                *out++ = c;
+            } else if (byte >= 'A' && byte <= 'Z') {
+                *out++ = static_cast<char>(byte - 'A' + 'a');
+            } else {
+                *out++ = ' ';
+            }
+        }
+        *out++ = ' ';
+    }
+
+    scratch.clear();
+    const char* start = nullptr;
+    for (const char* c = folded.data(); c != out; ++c) {
+        if (*c != ' ') {
+            if (!start) {
+                start = c;
+            }
+        } else if (start) {
+            scratch.emplace_back(start, static_cast<std::size_t>(c - start));
+            start = nullptr;
+        }
+    }
+}
+
+void TextIndex::add(std::uint64_t id, Task* task, std::string_view name, std::string_view description) {
+    tokenize(name, description);
+    for (std::string_view word : scratch) {
+        bool inserted = false;
+        std::uint32_t& index = postings.insert(word, inserted);
+        if (inserted) {
+            if (freeLists.empty()) {
+                index = static_cast<std::uint32_t>(lists.size());
+                lists.emplace_back();
+            } else {
+                index = freeLists.back();
+                freeLists.pop_back();
+            }
+            lists[index].word.assign(word.data(), word.size());
+            postings.rebind(lists[index].word);  // Ключ тепер вказує на копію слова у списку
+            vocabulary.push_back(index);
+            vocabularySorted = false;
+        }
+        std::vector<Posting>& entries = lists[index].entries;
+        if (entries.empty() || entries.back().id != id) {
+            entries.push_back({id, task});  // Повторне слово того ж завдання вже додано
+        }
+    }
+}
+
+void TextIndex::remove(std::uint64_t id, std::string_view name, std::string_view description) {
+    tokenize(name, description);
+    for (std::string_view word : scratch) {
+        const std::uint32_t* index = postings.find(word);
+        if (!index) {
+            continue;
+        }
+        PostingList* list = &lists[*index];
+        auto it = std::lower_bound(list->entries.begin(), list->entries.end(), id,
+                                   [](const Posting& posting, std::uint64_t value) { return posting.id < value; });
+        if (it == list->entries.end() || it->id != id || !it->task) {
+            continue;  // Слово не належить завданню або вже прибране (повторне слово)
+        }
+        it->task = nullptr;  // Позначаємо запис видаленим, не зсуваючи список
+        ++list->removed;
+        if (list->removed == list->entries.size()) {
+            // Звільняємо список; його номер лишається у словнику до наступного впорядкування
+            freeLists.push_back(*index);
+            postings.erase(word);
+            std::vector<Posting>().swap(list->entries);
+            list->removed = 0;
+        } else if (list->removed * 2 > list->entries.size()) {
+            // Ущільнюємо список, коли видалених записів більше, ніж живих
+            list->entries.erase(std::remove_if(list->entries.begin(), list->entries.end(),
+                                               [](const Posting& posting) { return !posting.task; }),
+                                list->entries.end());
+            list->removed = 0;
+        }
+    }
+}
+
+void TextIndex::matchPrefix(std::string_view prefix, std::vector<Posting>& result) {
+    if (!vocabularySorted) {
+        // Прибираємо вільні списки, впорядковуємо словник і прибираємо повтори повторно використаних списків
+        vocabulary.erase(std::remove_if(vocabulary.begin(), vocabulary.end(),
+                                        [this](std::uint32_t index) { return lists[index].entries.empty(); }),
+                         vocabulary.end());
+        std::sort(vocabulary.begin(), vocabulary.end(), [this](std::uint32_t a, std::uint32_t b) {
+            return lists[a].word < lists[b].word;
+        });
+        vocabulary.erase(std::unique(vocabulary.begin(), vocabulary.end()), vocabulary.end());
+        vocabularySorted = true;
+    }
+    auto it = std::lower_bound(vocabulary.begin(), vocabulary.end(), prefix, [this](std::uint32_t index, std::string_view value) {
+        return lists[index].word < value;
+    });
+    for (; it != vocabulary.end() && std::string_view(lists[*it].word).substr(0, prefix.size()) == prefix; ++it) {
+        for (const Posting& posting : lists[*it].entries) {
+            if (posting.task) {
+                result.push_back(posting);
+            }
+        }
+    }
+    std::sort(result.begin(), result.end(), [](const Posting& a, const Posting& b) { return a.id < b.id; });
+    result.erase(std::unique(result.begin(), result.end(), [](const Posting& a, const Posting& b) { return a.id == b.id; }),
+                 result.end());
+}
+
+std::vector<Task*> TextIndex::search(std::string_view query) {
+    auto byId = [](const Posting& a, const Posting& b) { return a.id < b.id; };
+    std::vector<Posting> matches;                                     // Результат усіх альтернатив (OR)
+    std::vector<std::pair<const Posting*, const Posting*>> wordLists;     // Списки слів поточної альтернативи (AND)
+    std::vector<std::vector<Posting>> prefixMatches;                  // Зібрані списки для префіксів
+
+    // Перетинає списки поточної альтернативи та додає результат до загального
+    auto finishGroup = [&]() {
+        if (!wordLists.empty()) {
+            // Починаємо з найкоротшого списку і шукаємо кожен номер у довших
+            std::sort(wordLists.begin(), wordLists.end(), [](const auto& a, const auto& b) { return a.second - a.first < b.second - b.first; });
+            std::vector<Posting> group;
+            for (const Posting* posting = wordLists[0].first; posting != wordLists[0].second; ++posting) {
+                if (posting->task) {
+                    group.push_back(*posting);
+                }
+            }
+            for (std::size_t i = 1; i < wordLists.size() && !group.empty(); ++i) {
+                const Posting* from = wordLists[i].first;
+                const Posting* end = wordLists[i].second;
+                std::size_t kept = 0;
+                for (const Posting& posting : group) {
+                    // Галопуючий пошук: крок подвоюється, доки не перескочимо номер, далі — двійковий пошук
+                    std::size_t step = 1;
+                    while (step < static_cast<std::size_t>(end - from) && from[step].id < posting.id) {
+                        step *= 2;
+                    }
+                    from = std::lower_bound(from + step / 2, from + std::min(step + 1, static_cast<std::size_t>(end - from)), posting, byId);
+                    if (from == end) {
+                        break;
+                    }
+                    if (from->id == posting.id) {
+                        group[kept++] = posting;  // Видалене завдання прибрано з усіх списків, тож запис живий
+                    }
+                }
+                group.resize(kept);
+            }
+            std::vector<Posting> merged;
+            merged.reserve(matches.size() + group.size());
+            std::set_union(matches.begin(), matches.end(), group.begin(), group.end(), std::back_inserter(merged), byId);
+            matches.swap(merged);
+        }
+        wordLists.clear();
+        prefixMatches.clear();
+    };
 
     while (true) {
-        displayMenu();  // Показати меню
-        std::cin >> choice;  // Отримати вибір користувача
+        std::string_view term = nextWord(query);
+        if (term.empty()) {
+            break;
+        }
+        if (term == "OR") {
+            finishGroup();
+            continue;
+        }
+        if (term == "AND") {
+            continue;  // Слова поруч і так поєднуються через AND
+        }
 
-        if (std::cin.fail()) {  // Якщо введено некоректні дані
-            std::cin.clear();  // Очищуємо стан помилки
-            std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');  // Пропускаємо некоректний ввід
-            std::cout << "Invalid input. Please enter a number.\n";
+        // Терм може містити кілька слів (наприклад, "task-42"); префіксом вважається лише останнє
+        bool prefix = term.size() > 1 && term.back() == '*';
+        if (prefix) {
+            term.remove_suffix(1);
+        }
+        tokenize(term, std::string_view());
+        for (const std::string_view& word : scratch) {
+            if (prefix && &word == &scratch.back()) {
+                prefixMatches.emplace_back();
+                matchPrefix(word, prefixMatches.back());
+                wordLists.emplace_back(prefixMatches.back().data(), prefixMatches.back().data() + prefixMatches.back().size());
+            } else if (const std::uint32_t* index = postings.find(word)) {
+                const std::vector<Posting>& entries = this->lists[*index].entries;
+                wordLists.emplace_back(entries.data(), entries.data() + entries.size());
+            } else {
+                wordLists.emplace_back(nullptr, nullptr);  // Слова немає — альтернатива нічого не знайде
+            }
+        }
+    }
+    finishGroup();
+
+    std::vector<Task*> result;
+    result.reserve(matches.size());
+    for (const Posting& posting : matches) {
+        result.push_back(posting.task);
+    }
+    return result;
+}
+
+void TextIndex::clear() {
+    lists.clear();
+    freeLists.clear();
+    postings.clear();
+    vocabulary.clear();
+    vocabularySorted = true;
+}
+
+// Як поводитися із завданнями, що мають однакові назви
+enum class DuplicatePolicy {
+    Keep,     // Зберігати всі завдання (поведінка за замовчуванням)
+    Skip,     // Пропускати нове завдання, якщо назва вже існує
+    Replace   // Замінювати існуючі завдання з такою ж назвою новим
+};
+
+// Файл, відображений у пам'ять лише для читання (mmap)
+class MappedFile {
+    const char* data = nullptr;  // Початок вмісту файлу
+    std::size_t length = 0;      // Розмір файлу
+    bool mapped = false;         // Чи відображено файл через mmap (інакше — прочитано в буфер)
+    std::unique_ptr<char[]> buffer;  // Буфер, якщо mmap недоступний
+
+public:
+    // Відкриває файл; кидає std::runtime_error, якщо його не вдалося прочитати
+    explicit MappedFile(const std::string& fileName);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    std::string_view contents() const { return std::string_view(data, length); }
+};
+
+MappedFile::MappedFile(const std::string& fileName) {
+    int fd = ::open(fileName.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Error: can't open file for reading");
+    }
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Error: can't read file size");
+    }
+    length = static_cast<std::size_t>(info.st_size);
+
+    if (length > 0) {
+        void* address = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address != MAP_FAILED) {
+            ::madvise(address, length, MADV_SEQUENTIAL);  // Файл читається послідовно
+            data = static_cast<const char*>(address);
+            mapped = true;
+        } else {
+            // Якщо mmap недоступний, читаємо файл у буфер
+            buffer.reset(new char[length]);
+            std::size_t done = 0;
+            while (done < length) {
+                ssize_t got = ::read(fd, buffer.get() + done, length - done);
+                if (got <= 0) {
+                    ::close(fd);
+                    throw std::runtime_error("Error: can't read file");
+                }
+                done += static_cast<std::size_t>(got);
+            }
+            data = buffer.get();
+        }
+    }
+    ::close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (mapped) {
+        ::munmap(const_cast<char*>(data), length);
+    }
+}
+
+// Завдання, розібране з рядка файлу (рядки вказують у вміст файлу, без копіювання)
+struct ParsedTask {
+    TaskKind kind = TaskKind::Normal;
+    std::string_view name;
+    std::string_view description;
+    std::int32_t deadlineDay = 0;
+    int priority = 0;
+    std::string unescaped;  // Поля рядка з екранованими символами
+};
+
+// Помилка розбору рядка файлу
+struct LoadError {
+    std::size_t line = 0;  // Номер рядка (з 1)
+    std::string message;   // Опис помилки
+};
+
+// Результат завантаження файлу
+struct LoadReport {
+    static constexpr std::size_t maxErrors = 100;  // Скільки помилок зберігати детально
+
+    std::size_t loaded = 0;      // Кількість доданих завдань
+    std::size_t duplicates = 0;  // Кількість пропущених дублікатів
+    std::size_t rejected = 0;    // Кількість некоректних рядків
+    bool failed = false;         // Файл не вдалося прочитати (помилку вже виведено)
+    std::uint64_t bytesRead = 0; // Скільки байтів файлу прочитало потокове читання
+    std::vector<LoadError> errors;  // Перші maxErrors помилок
+
+    // Записує помилку для рядка
+    void reject(std::size_t line, const char* message) {
+        if (errors.size() < maxErrors) {
+            errors.push_back({line, message});
+        }
+        ++rejected;
+    }
+
+    // Виводить зведення: скільки пропущено дублікатів і некоректних рядків
+    void printSummary() const {
+        if (duplicates > 0) {
+            std::cout << "Skipped " << duplicates << " tasks with duplicate names\n";
+        }
+        if (rejected > 0) {
+            // Одне зведене повідомлення замість рядка журналу на кожну помилку
+            const LoadError& first = errors.front();
+            std::cerr << "Skipped " << rejected << " malformed entries (first at line " << first.line << ": " << first.message << ")\n";
+        }
+    }
+};
+
+// Розбирає ціле число, що займає весь текст; повертає false, якщо текст порожній або має зайві символи
+template <typename Number>
+bool parseNumber(std::string_view text, Number& value) {
+    const char* end = text.data() + text.size();
+    auto result = std::from_chars(text.data(), end, value);
+    return result.ec == std::errc() && result.ptr == end && !text.empty();
+}
+
+// Розбирає дату фіксованого формату YYYY-MM-DD у номер дня; повертає false, якщо формат некоректний
+inline bool parseDate(std::string_view text, std::int32_t& days) {
+    if (text.size() < 10 || text[4] != '-' || text[7] != '-') {
+        return false;
+    }
+    int digits[8];
+    const int positions[8] = {0, 1, 2, 3, 5, 6, 8, 9};
+    for (int i = 0; i < 8; ++i) {
+        unsigned digit = static_cast<unsigned>(text[positions[i]] - '0');
+        if (digit > 9) {
+            return false;
+        }
+        digits[i] = static_cast<int>(digit);
+    }
+    int year = digits[0] * 1000 + digits[1] * 100 + digits[2] * 10 + digits[3];
+    int month = digits[4] * 10 + digits[5];
+    int day = digits[6] * 10 + digits[7];
+    if (month < 1 || month > 12 || day < 1 || day > 31) {
+        return false;
+    }
+    days = daysFromCivil(year, month, 1) + day - 1;  // Дні понад кінець місяця переносяться, як у mktime
+    return true;
+}
+
+// Розбиває рядок на поля за роздільником '|' (не більше maxFields); повертає кількість полів
+inline std::size_t splitFields(std::string_view line, std::string_view* fields, std::size_t maxFields) {
+    std::size_t count = 0;
+    while (count < maxFields) {
+        std::size_t end = line.find('|');
+        fields[count++] = line.substr(0, end);
+        if (end == std::string_view::npos) {
+            break;
+        }
+        line.remove_prefix(end + 1);
+    }
+    return count;
+}
+
+// Перший рядок текстового файлу, поля якого екрановані. save пише його лише тоді, коли якесь поле містить
+// '\\', '|' або переведення рядка; файли без нього (зокрема збережені старими версіями) читаються дослівно
+constexpr std::string_view escapedFileHeader = "#taskfile escaped";
+
+// Чи починається текст файлу завдань заголовком escapedFileHeader
+inline bool hasEscapedHeader(std::string_view text) {
+    return text.substr(0, escapedFileHeader.size()) == escapedFileHeader &&
+           (text.size() == escapedFileHeader.size() || text[escapedFileHeader.size()] == '\n' || text[escapedFileHeader.size()] == '\r');
+}
+
+// Розбиває на поля рядок з екранованими символами (\\, \|, \n, \r), знімаючи екранування.
+// Поля вказують у storage, тому дійсні до наступного виклику
+inline std::size_t splitEscapedFields(std::string_view line, std::string& storage, std::string_view* fields, std::size_t maxFields) {
+    storage.clear();
+    storage.reserve(line.size());  // Без перевиділення під час розбору — поля лишаються дійсними
+    std::size_t count = 0;
+    std::size_t start = 0;
+    for (std::size_t i = 0; i < line.size() && count < maxFields; ++i) {
+        char c = line[i];
+        if (c == '\\' && i + 1 < line.size()) {
+            char escaped = line[++i];
+            storage.push_back(escaped == 'n' ? '\n' : escaped == 'r' ? '\r' : escaped);
+        } else if (c == '|') {
+            fields[count++] = std::string_view(storage.data() + start, storage.size() - start);
+            start = storage.size();
+        } else {
+            storage.push_back(c);
+        }
+    }
+    if (count < maxFields) {
+        fields[count++] = std::string_view(storage.data() + start, storage.size() - start);
+    }
+    return count;
+}
+
+// Чи містить рядок символи, які у файлі завдань потрібно екранувати
+inline bool needsEscaping(std::string_view text) {
+    return text.find_first_of("\\|\n\r") != std::string_view::npos;
+}
+
+// Дописує рядок до out, екрануючи символи, що мають особливе значення у файлі завдань
+inline void appendEscaped(std::string& out, std::string_view text) {
+    if (!needsEscaping(text)) {
+        out.append(text.data(), text.size());  // Найчастіший випадок — екранувати нічого
+        return;
+    }
+    for (char c : text) {
+        switch (c) {
+            case '\\': out += "\\\\"; break;
+            case '|': out += "\\|"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            default: out += c;
+        }
+    }
+}
+
+// Записує рядок у потік, екрануючи символи, що мають особливе значення у файлі завдань
+inline void writeEscaped(std::ostream& os, std::string_view text) {
+    if (!needsEscaping(text)) {
+        os << text;  // Найчастіший випадок — екранувати нічого
+        return;
+    }
+    std::string escaped;
+    appendEscaped(escaped, text);
+    os << escaped;
+}
+
+// Розбирає рядок формату Type|name|description|YYYY-MM-DD[|priority]; повертає опис помилки або nullptr.
+// escaped — чи знімати екранування (рядки журналу, команди та файли з escapedFileHeader)
+inline const char* parseTaskLine(std::string_view line, bool escaped, ParsedTask& task) {
+    std::string_view fields[5];
+    std::size_t count = escaped && std::memchr(line.data(), '\\', line.size())
+        ? splitEscapedFields(line, task.unescaped, fields, 5)
+        : splitFields(line, fields, 5);
+    if (count < 4) {
+        return "expected Type|name|description|YYYY-MM-DD";
+    }
+    task.name = fields[1];
+    task.description = fields[2];
+
+    if (!parseTaskKind(fields[0], task.kind)) {
+        return "unknown task type";
+    }
+    task.priority = 0;
+    if (kindInfo(task.kind).hasPriority) {
+        if (count < 5) {
+            return "missing priority";
+        }
+        const char* end = fields[4].data() + fields[4].size();
+        auto result = std::from_chars(fields[4].data(), end, task.priority);
+        if (result.ec != std::errc() || result.ptr != end) {
+            return "invalid priority";
+        }
+    }
+
+    if (!parseDate(fields[3], task.deadlineDay)) {
+        return "invalid date, expected YYYY-MM-DD";
+    }
+    return nullptr;
+}
+
+// Розбирає текст файлу завдань рядок за рядком і передає кожне завдання у onTask(const ParsedTask&).
+// firstLine — номер першого рядка тексту (для повідомлень про помилки), escaped — чи має файл escapedFileHeader
+// (сам заголовок пропускається); повертає номер рядка після тексту
+template <typename Callback>
+std::size_t parseTaskText(std::string_view text, std::size_t firstLine, bool escaped, LoadReport& report, Callback&& onTask) {
+    ParsedTask task;
+    std::size_t lineNumber = firstLine;
+    while (!text.empty()) {
+        const char* newline = static_cast<const char*>(std::memchr(text.data(), '\n', text.size()));
+        std::size_t length = newline ? static_cast<std::size_t>(newline - text.data()) : text.size();
+        std::string_view line = text.substr(0, length);
+        text.remove_prefix(newline ? length + 1 : length);
+
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);  // Файли з Windows-закінченнями рядків
+        }
+        if (!line.empty() && !(escaped && line == escapedFileHeader)) {
+            if (const char* error = parseTaskLine(line, escaped, task)) {
+                report.reject(lineNumber, error);
+            } else {
+                onTask(task);
+            }
+        }
+        ++lineNumber;
+    }
+    return lineNumber;
+}
+
+// Арена для завдань та їхніх рядків: пам'ять береться у пулу великими блоками
+// і повертається системі разом з ареною, а не по одному завданню.
+// Арена не є потокобезпечною: кожен потік має використовувати власну.
+class TaskArena {
+    std::pmr::unsynchronized_pool_resource pool;    // Пул блоків пам'яті
+    std::pmr::monotonic_buffer_resource block;      // Один наперед виділений блок (лише для арени з розміром)
+    std::pmr::memory_resource* memory = &pool;      // Ресурс, з якого беруться завдання та рядки
+
+public:
+    // Розмір і вирівнювання комірки для будь-якого типу завдання
+    static constexpr std::size_t slotSize = TaskClassSlot::size;
+    static constexpr std::size_t slotAlign = TaskClassSlot::align;
+
+    TaskArena() = default;
+
+    // Арена одного блоку: виділення лише зсуває покажчик у блоці, а пам'ять видалених завдань
+    // не використовується повторно до звільнення арени (для відновлення знімка, розмір якого відомий наперед)
+    explicit TaskArena(std::size_t blockSize) : block(blockSize), memory(&block) {}
+
+    // Скільки пам'яті арени займе завдання з рядками такої довжини (з урахуванням вирівнювання комірки)
+    static std::size_t taskBytes(std::size_t nameLength, std::size_t descriptionLength);
+
+    // Створює завдання з розібраного рядка; завдання та його рядки розміщуються в арені
+    Task* create(const ParsedTask& parsed);
+    
+    // Знищує завдання: створене в арені повертає пам'ять у свою арену, інше видаляється через delete
+    static void destroy(Task* task);
+    
+    // Ресурс пам'яті арени (для контейнерів, що мають жити в ній)
+    std::pmr::memory_resource* resource() { return memory; }
+    
+    // Звільняє всю пам'ять арени; завдання в ній після цього недійсні
+    void release() {
+        pool.release();
+        block.release();
+    }
+};
+
+std::size_t TaskArena::taskBytes(std::size_t nameLength, std::size_t descriptionLength) {
+    static const std::size_t inlineLength = TaskString().capacity();  // Коротші рядки не виділяють пам'ять
+    std::size_t bytes = slotSize + slotAlign - 1;  // Після рядків наступна комірка може потребувати вирівнювання
+    for (std::size_t length : {nameLength, descriptionLength}) {
+        bytes += length > inlineLength ? length + 1 : 0;
+    }
+    return bytes;
+}
+
+Task* TaskArena::create(const ParsedTask& parsed) {
+    void* slot = memory->allocate(slotSize, slotAlign);
+    Task* task = nullptr;
+    try {
+        // Рядки виділяються в арені одразу на місці та переміщуються в завдання
+        switch (parsed.kind) {  // Без default: -Wswitch повідомить про тип без гілки
+            case TaskKind::Normal:
+                task = new (slot) NormalTask(TaskString(parsed.name, memory), TaskString(parsed.description, memory), parsed.deadlineDay);
+                break;
+            case TaskKind::Important:
+                task = new (slot) ImportantTask(TaskString(parsed.name, memory), TaskString(parsed.description, memory), parsed.deadlineDay, parsed.priority);
+                break;
+        }
+        if (!task) {
+            throw std::invalid_argument("unknown task kind");  // Розбір і знімки перевіряють тип раніше
+        }
+    } catch (...) {
+        memory->deallocate(slot, slotSize, slotAlign);
+        throw;
+    }
+    task->pooled = true;
+    return task;
+}
+
+void TaskArena::destroy(Task* task) {
+    if (!task->pooled) {
+        delete task;
+        return;
+    }
+    std::pmr::memory_resource* owner = task->taskName.get_allocator().resource();  // Рядки завдання лежать у тій самій арені
+    task->~Task();
+    owner->deallocate(task, slotSize, slotAlign);
+}
+
+// Бінарний знімок завдань: заголовок, записи фіксованого розміру, блок рядків.
+// Числа записуються у порядку байтів машини (little-endian на підтримуваних платформах).
+constexpr char snapshotMagic[8] = {'T', 'A', 'S', 'K', 'S', 'N', 'A', 'P'};
+constexpr std::uint32_t snapshotVersion = 2;
+constexpr std::uint32_t snapshotOldestVersion = 1;  // Версія 1 не зберігала вік: він збігається з порядком записів
+constexpr const char* snapshotExtension = ".tsnap";  // Файли з цим розширенням зберігаються як знімок
+
+// Заголовок знімка
+struct SnapshotHeader {
+    char magic[8];              // snapshotMagic
+    std::uint32_t version;      // snapshotVersion
+    std::uint32_t recordSize;   // sizeof(SnapshotRecord)
+    std::uint64_t taskCount;    // Кількість записів
+    std::uint64_t stringBytes;  // Розмір блоку рядків
+};
+
+// Запис про одне завдання; рядки задаються зміщенням у блоці рядків
+struct SnapshotRecord {
+    std::uint64_t nameOffset;
+    std::uint64_t descriptionOffset;
+    std::uint32_t nameLength;
+    std::uint32_t descriptionLength;
+    std::int32_t deadlineDay;
+    std::int32_t priority;
+    std::uint8_t kind;          // TaskKind
+    std::uint8_t reserved[3];
+    std::uint32_t age;          // Місце завдання за віком (порядком додавання) серед записів знімка
+};
+
+// Чи зберігати файл як бінарний знімок (за розширенням)
+inline bool isSnapshotFileName(const std::string& fileName) {
+    std::size_t length = std::strlen(snapshotExtension);
+    return fileName.size() >= length && fileName.compare(fileName.size() - length, length, snapshotExtension) == 0;
+}
+
+// Чи є вміст файлу бінарним знімком (за сигнатурою)
+inline bool isSnapshot(std::string_view contents) {
+    return contents.size() >= sizeof(snapshotMagic) && std::memcmp(contents.data(), snapshotMagic, sizeof(snapshotMagic)) == 0;
+}
+
+// Умова потокового запиту до файлу завдань: дедлайн, пріоритет і частина назви
+struct TaskQuery {
+    TaskFilter filter;         // Умова за дедлайном і пріоритетом
+    std::string nameContains;  // Назва містить цей рядок (порожній — будь-яка назва)
+
+    bool matches(const ParsedTask& task) const {
+        return filter.matches(task.kind, task.priority, task.deadlineDay) &&
+               (nameContains.empty() || task.name.find(nameContains) != std::string_view::npos);
+    }
+};
+
+// Читає рівно size байтів з позиції offset; кидає std::runtime_error
+inline void readAt(int fd, void* data, std::size_t size, off_t offset) {
+    char* out = static_cast<char*>(data);
+    while (size > 0) {
+        ssize_t count = ::pread(fd, out, size, offset);
+        if (count < 0 && errno == EINTR) {
             continue;
         }
+        if (count <= 0) {
+            throw std::runtime_error("Error: can't read file");
+        }
+        out += count;
+        size -= static_cast<std::size_t>(count);
+        offset += count;
+    }
+}
+
+// Переглядає знімок записами через pread: рядки читаються лише для записів, що пройшли умову за дедлайном і пріоритетом
+template <typename Callback>
+void streamSnapshot(int fd, const TaskQuery& query, LoadReport& report, Callback&& onTask) {
+    SnapshotHeader header;
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || static_cast<std::uint64_t>(info.st_size) < sizeof(header)) {
+        throw std::runtime_error("Error: truncated snapshot header");
+    }
+    readAt(fd, &header, sizeof(header), 0);
+    report.bytesRead += sizeof(header);
+    if (header.version < snapshotOldestVersion || header.version > snapshotVersion || header.recordSize != sizeof(SnapshotRecord)) {
+        throw std::runtime_error("Error: unsupported snapshot version");
+    }
+    std::uint64_t available = static_cast<std::uint64_t>(info.st_size) - sizeof(header);
+    if (header.taskCount > available / sizeof(SnapshotRecord) ||
+        header.stringBytes != available - header.taskCount * sizeof(SnapshotRecord)) {
+        throw std::runtime_error("Error: snapshot size does not match its header");
+    }
+
+    const off_t stringsOffset = static_cast<off_t>(sizeof(header) + header.taskCount * sizeof(SnapshotRecord));
+    constexpr std::size_t blockRecords = 4096;
+    std::unique_ptr<SnapshotRecord[]> records(new SnapshotRecord[blockRecords]);
+    std::string name, description;
+    ParsedTask parsed;
+    for (std::uint64_t first = 0; first < header.taskCount; first += blockRecords) {
+        std::size_t count = static_cast<std::size_t>(std::min<std::uint64_t>(blockRecords, header.taskCount - first));
+        readAt(fd, records.get(), count * sizeof(SnapshotRecord), static_cast<off_t>(sizeof(header) + first * sizeof(SnapshotRecord)));
+        report.bytesRead += count * sizeof(SnapshotRecord);
+        for (std::size_t i = 0; i < count; ++i) {
+            const SnapshotRecord& record = records[i];
+            if (record.nameOffset > header.stringBytes || record.nameLength > header.stringBytes - record.nameOffset ||
+                record.descriptionOffset > header.stringBytes || record.descriptionLength > header.stringBytes - record.descriptionOffset ||
+                record.kind >= taskKindCount) {
+                report.reject(static_cast<std::size_t>(first + i + 1), "corrupt snapshot record");  // Номер запису замість номера рядка
+                continue;
+            }
+            if (!query.filter.matches(static_cast<TaskKind>(record.kind), record.priority, record.deadlineDay)) {
+                continue;
+            }
+            name.resize(record.nameLength);
+            readAt(fd, name.data(), name.size(), stringsOffset + static_cast<off_t>(record.nameOffset));
+            report.bytesRead += name.size();
+            parsed.name = name;
+            if (!query.nameContains.empty() && parsed.name.find(query.nameContains) == std::string_view::npos) {
+                continue;
+            }
+            description.resize(record.descriptionLength);
+            readAt(fd, description.data(), description.size(), stringsOffset + static_cast<off_t>(record.descriptionOffset));
+            report.bytesRead += description.size();
+            parsed.kind = static_cast<TaskKind>(record.kind);
+            parsed.description = description;
+            parsed.deadlineDay = record.deadlineDay;
+            parsed.priority = record.priority;
+            onTask(parsed);
+        }
+    }
+}
+
+// Читає файл завдань (текст або знімок) через буфер і передає onTask кожне завдання,
+// що задовольняє запит (рядки ParsedTask дійсні лише під час виклику). Пам'ять не залежить від розміру файлу:
+// буфер росте лише під рядок, довший за нього. Кидає std::runtime_error, якщо файл не вдалося прочитати
+template <typename Callback>
+LoadReport streamTaskFile(const std::string& fileName, const TaskQuery& query, Callback&& onTask) {
+    constexpr std::size_t initialBufferSize = 1 << 20;
+    int fd = ::open(fileName.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Error: can't open file for reading");
+    }
+    LoadReport report;
+    try {
+        char head[32];  // Вміщує сигнатуру знімка та escapedFileHeader
+        ssize_t headLength = ::pread(fd, head, sizeof(head), 0);
+        std::string_view start(head, headLength > 0 ? static_cast<std::size_t>(headLength) : 0);
+        if (isSnapshot(start)) {
+            streamSnapshot(fd, query, report, onTask);
+            ::close(fd);
+            return report;
+        }
+        const bool escaped = hasEscapedHeader(start);
+#ifdef POSIX_FADV_SEQUENTIAL
+        ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);  // Підказка є не на всіх системах (немає на macOS)
+#endif
+
+        std::vector<char> buffer(initialBufferSize);
+        std::size_t used = 0;           // Байтів у буфері: недочитаний рядок з попередньої частини та нові дані
+        std::size_t lineNumber = 1;     // Номер першого рядка в буфері
+        auto onLine = [&query, &onTask](const ParsedTask& parsed) {
+            if (query.matches(parsed)) {
+                onTask(parsed);
+            }
+        };
+        while (true) {
+            ssize_t count = ::read(fd, buffer.data() + used, buffer.size() - used);
+            if (count < 0 && errno == EINTR) {
+                continue;
+            }
+            if (count < 0) {
+                throw std::runtime_error("Error: can't read file");
+            }
+            const bool end = count == 0;
+            used += static_cast<std::size_t>(count);
+            report.bytesRead += static_cast<std::size_t>(count);
+            std::string_view text(buffer.data(), used);
+
+            // Розбираються лише цілі рядки; хвіст без '\n' переноситься на початок буфера
+            std::size_t complete = end ? text.size() : text.rfind('\n') + 1;  // npos + 1 == 0
+            if (complete == 0 && used == buffer.size()) {
+                buffer.resize(buffer.size() * 2);  // Рядок не вміщується — читаємо його далі у більший буфер, як це робить load
+                continue;
+            }
+            lineNumber = parseTaskText(text.substr(0, complete), lineNumber, escaped, report, onLine);
+            std::string_view rest = text.substr(complete);
+            std::memmove(buffer.data(), rest.data(), rest.size());
+            used = rest.size();
+            if (end) {
+                break;
+            }
+        }
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+    ::close(fd);
+    return report;
+}
+
+// Записує у звіт завдання з файлу, що задовольняють запит, не завантажуючи їх;
+// loaded у результаті — кількість записаних завдань. Кидає std::runtime_error
+inline LoadReport writeMatchingTasks(const std::string& fileName, const TaskQuery& query, ReportWriter& writer) {
+    std::size_t matches = 0;
+    LoadReport report = streamTaskFile(fileName, query, [&writer, &matches](const ParsedTask& parsed) {
+        if (matches++ == 0) {
+            writer.writeHeader();  // Заголовок — лише після того, як файл вдалося відкрити
+        }
+        writer.writeRow(parsed.kind, parsed.priority, parsed.deadlineDay, parsed.name, parsed.description);
+    });
+    if (matches == 0) {
+        writer.writeHeader();
+    }
+    report.loaded = matches;
+    return report;
+}
+
+// Поле, за яким сортуються завдання
+enum class SortField {
+    None,        // Без ключа (зберігається поточний порядок)
+    Importance,  // Спочатку важливі завдання, більший пріоритет вище
+    Deadline     // Раніший дедлайн вище
+};
+
+// Журнал змін (write-ahead log): кожна зміна дописується рядком у кінець файлу.
+// Перший рядок — заголовок "TASKJOURNAL <версія> <хеш знімка>", далі записи "<контрольна сума> <тип> <дані>":
+//   A Type|name|description|YYYY-MM-DD[|priority]   D name[|n]   C   S <поле> <поле>
+// (D видаляє n-те за віком завдання з цією назвою, без n — найстаріше)
+// Записи накопичуються у буфері, і ціла група скидається на диск одним write та fsync (group commit).
+// Фоновий потік скидає групу, щойно перший запис у ній чекає groupCommitDelay, навіть якщо нових змін немає.
+constexpr const char* journalMagic = "TASKJOURNAL";
+constexpr int journalVersion = 1;
+constexpr const char* journalExtension = ".journal";
+
+class TaskJournal {
+public:
+    static constexpr std::size_t groupCommitRecords = 256;             // Найбільше записів в одній групі
+    static constexpr std::chrono::milliseconds groupCommitDelay{10};   // Найдовше очікування запису в буфері
+
+private:
+    int fd = -1;                  // Дескриптор файлу журналу
+    off_t fileSize = 0;           // Розмір файлу після останньої успішної групи
+    std::string pending;          // Записи, ще не скинуті на диск
+    std::string record;           // Буфер для поточного запису (лише потік власника)
+    std::size_t pendingRecords = 0;  // Кількість записів у буфері
+    std::chrono::steady_clock::time_point firstPending;  // Коли до буфера потрапив перший запис групи
+    std::size_t records = 0;      // Кількість записів у файлі (разом із буфером)
+    std::size_t syncs = 0;        // Кількість викликів fsync
+
+    mutable std::mutex mutex;       // Захищає буфер і файл від одночасного доступу власника та фонового потоку
+    std::condition_variable wake;   // Будить фоновий потік, коли з'являється перший запис групи або журнал закривається
+    bool stopping = false;          // Журнал закривається
+    bool flushFailed = false;       // Фоновий запис не вдався; наступна спроба — після нового запису
+    std::thread flusher;            // Фоновий потік, що скидає групу через groupCommitDelay
+
+    // Додає до буфера запис із record разом із контрольною сумою
+    void appendRecord();
+
+    // Записує буфер у файл і викликає fsync; викликається під mutex
+    void commitLocked();
+
+    // Тіло фонового потоку
+    void flushLoop();
+
+public:
+    // Створює новий журнал для знімка з хешем snapshotHash (validBytes == 0)
+    // або продовжує наявний, відкидаючи все після перших validBytes байтів; кидає std::runtime_error
+    TaskJournal(const std::string& fileName, std::uint64_t snapshotHash, std::size_t validBytes, std::size_t validRecords);
+    ~TaskJournal();
+
+    TaskJournal(const TaskJournal&) = delete;
+    TaskJournal& operator=(const TaskJournal&) = delete;
+
+    void logAdd(TaskKind kind, int priority, std::int32_t deadlineDay, std::string_view name, std::string_view description);
+    void logDelete(std::string_view name, std::size_t occurrence = 0);
+    void logClear();
+    void logSort(SortField primary, SortField secondary);
+
+    // Чи час скинути групу на диск (група заповнилася або перший запис чекає надто довго)
+    bool commitDue() const;
+
+    // Записує буфер у файл і викликає fsync; кидає std::runtime_error
+    void commit();
+
+    std::size_t recordCount() const { return records; }  // Змінюється лише потоком власника
+    std::size_t syncCount() const;
+};
+
+TaskJournal::TaskJournal(const std::string& fileName, std::uint64_t snapshotHash, std::size_t validBytes, std::size_t validRecords)
+    : records(validRecords) {
+    fd = ::open(fileName.c_str(), validBytes == 0 ? O_WRONLY | O_APPEND | O_CREAT | O_TRUNC : O_WRONLY | O_APPEND, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Error: can't open journal for writing");
+    }
+    if (validBytes == 0) {
+        char header[64];
+        int length = std::snprintf(header, sizeof(header), "%s %d %016llx\n", journalMagic, journalVersion,
+                                   static_cast<unsigned long long>(snapshotHash));
+        pending.assign(header, static_cast<std::size_t>(length));
+    } else if (::ftruncate(fd, static_cast<off_t>(validBytes)) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Error: can't truncate journal");  // Відкидаємо недописаний хвіст
+    }
+    fileSize = static_cast<off_t>(validBytes);
+    try {
+        commitLocked();  // Заголовок має бути на диску до першого запису; потоку ще немає
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+    flusher = std::thread(&TaskJournal::flushLoop, this);
+}
+
+TaskJournal::~TaskJournal() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    flusher.join();
+    try {
+        commit();
+    } catch (const std::exception& e) {
+        std::cerr << "Error occurred during journal write: " << e.what() << "\n";
+    }
+    ::close(fd);
+}
+
+void TaskJournal::flushLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        if (pendingRecords == 0 || flushFailed) {
+            wake.wait(lock);
+            continue;
+        }
+        if (std::chrono::steady_clock::now() < firstPending + groupCommitDelay) {
+            wake.wait_until(lock, firstPending + groupCommitDelay);
+            continue;  // Групу міг уже скинути власник, або журнал закривається
+        }
+        try {
+            commitLocked();
+        } catch (const std::exception& e) {
+            std::cerr << "Error occurred during journal write: " << e.what() << "\n";  // Записи лишаються в буфері
+            flushFailed = true;
+        }
+    }
+}
+
+std::size_t TaskJournal::syncCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return syncs;
+}
+
+void TaskJournal::appendRecord() {
+    char checksum[17];
+    std::snprintf(checksum, sizeof(checksum), "%016llx", static_cast<unsigned long long>(hashString(record)));
+    bool first;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        first = pendingRecords == 0 || flushFailed;
+        if (pendingRecords == 0) {
+            firstPending = std::chrono::steady_clock::now();
+        }
+        flushFailed = false;
+        pending.append(checksum, 16);
+        pending += ' ';
+        pending += record;
+        pending += '\n';
+        ++pendingRecords;
+        ++records;
+    }
+    if (first) {
+        wake.notify_one();  // Фоновий потік починає відлік для нової групи
+    }
+}
+
+void TaskJournal::logAdd(TaskKind kind, int priority, std::int32_t deadlineDay, std::string_view name, std::string_view description) {
+    char date[32];
+    formatDay(deadlineDay, date);
+    const TaskKindInfo& info = kindInfo(kind);
+    record.assign("A ");
+    record.append(info.name.data(), info.name.size());
+    record += '|';
+    appendEscaped(record, name);
+    record += '|';
+    appendEscaped(record, description);
+    record += '|';
+    record += date;
+    if (info.hasPriority) {
+        record += '|';
+        record += std::to_string(priority);
+    }
+    appendRecord();
+}
+
+void TaskJournal::logDelete(std::string_view name, std::size_t occurrence) {
+    record.assign("D ");
+    appendEscaped(record, name);
+    if (occurrence > 0) {
+        record += '|';
+        record += std::to_string(occurrence);
+    }
+    appendRecord();
+}
+
+void TaskJournal::logClear() {
+    record.assign("C");
+    appendRecord();
+}
+
+void TaskJournal::logSort(SortField primary, SortField secondary) {
+    record.assign("S ");
+    record += std::to_string(static_cast<int>(primary));
+    record += ' ';
+    record += std::to_string(static_cast<int>(secondary));
+    appendRecord();
+}
+
+bool TaskJournal::commitDue() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return pendingRecords >= groupCommitRecords ||
+           (pendingRecords > 0 && std::chrono::steady_clock::now() - firstPending >= groupCommitDelay);
+}
+
+void TaskJournal::commit() {
+    std::lock_guard<std::mutex> lock(mutex);
+    commitLocked();
+}
+
+void TaskJournal::commitLocked() {
+    if (pending.empty()) {
+        return;
+    }
+    std::size_t done = 0;
+    while (done < pending.size()) {
+        ssize_t written = ::write(fd, pending.data() + done, pending.size() - done);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            // Прибираємо частково записану групу; буфер лишається для повтору
+            if (::ftruncate(fd, fileSize) != 0) {
+                throw std::runtime_error("Error: can't write journal or roll back the partial write");
+            }
+            throw std::runtime_error("Error: can't write journal");
+        }
+        done += static_cast<std::size_t>(written);
+    }
+#ifdef __APPLE__
+    // На macOS немає fdatasync, а fsync не чекає, доки диск скине свій кеш
+    bool synced = ::fcntl(fd, F_FULLFSYNC) == 0;
+#else
+    bool synced = ::fdatasync(fd) == 0;
+#endif
+    if (!synced) {
+        throw std::runtime_error("Error: can't sync journal to disk");
+    }
+    fileSize += static_cast<off_t>(pending.size());
+    ++syncs;
+    pending.clear();
+    pendingRecords = 0;
+}
+
+// Викликає fsync для файлу або каталогу; повертає false у разі помилки
+inline bool syncPath(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    bool synced = ::fsync(fd) == 0;
+    ::close(fd);
+    return synced;
+}
+
+// Вбудовані лічильники та гістограми тривалостей операцій TaskMananger.
+// Збирання -DTASK_METRICS=0 прибирає їх повністю: макроси нижче нічого не роблять, а менеджер не містить лічильників
+#ifndef TASK_METRICS
+#define TASK_METRICS 1
+#endif
+
+// Підрахунок виділень пам'яті: -DTASK_COUNT_ALLOCATIONS=1 (разом з TASK_METRICS) замінює глобальний operator new
+// лічильником. Це лише для вимірювань: атомарний лічильник стоїть на кожному виділенні в процесі.
+// Лічильник спільний для всіх потоків, тож кількість виділень за операцію точна лише в однопотоковій програмі
+#ifndef TASK_COUNT_ALLOCATIONS
+#define TASK_COUNT_ALLOCATIONS 0
+#endif
+
+#if TASK_METRICS && TASK_COUNT_ALLOCATIONS
+constexpr bool countsAllocations = true;
+
+// Кількість викликів глобального operator new
+std::atomic<std::size_t> allocationCount{0};
+#else
+constexpr bool countsAllocations = false;
+#endif
+
+// Кількість виділень пам'яті від запуску програми (0, якщо підрахунок вимкнено)
+inline std::size_t allocationsSoFar() {
+#if TASK_METRICS && TASK_COUNT_ALLOCATIONS
+    return allocationCount.load(std::memory_order_relaxed);
+#else
+    return 0;
+#endif
+}
+
+// Гістограма тривалостей у стилі HDR: діапазони за степенями двійки, кожен поділений на 8 рівних частин,
+// тож похибка значення не перевищує 12,5% на будь-якому масштабі — від наносекунд до хвилин
+class LatencyHistogram {
+    static constexpr int subBits = 3;
+    static constexpr int subBuckets = 1 << subBits;
+    static constexpr int bucketCount = (64 - subBits + 1) * subBuckets;
+
+    std::uint64_t counts[bucketCount] = {};  // Кількість значень у кожному діапазоні
+    std::uint64_t total = 0;                 // Загальна кількість значень
+    std::uint64_t sum = 0;                   // Сума значень
+    std::uint64_t maxValue = 0;              // Найбільше значення
+
+    // Номер діапазону для значення
+    static int bucketFor(std::uint64_t value);
+
+    // Найбільше значення, що потрапляє в діапазон
+    static std::uint64_t bucketUpper(int bucket);
+
+public:
+    void record(std::uint64_t value);
+
+    // Значення, не менше за яке частка fraction усіх значень (з точністю діапазону)
+    std::uint64_t percentile(double fraction) const;
+
+    std::uint64_t count() const { return total; }
+    std::uint64_t max() const { return maxValue; }
+    double mean() const { return total ? static_cast<double>(sum) / static_cast<double>(total) : 0.0; }
+};
+
+int LatencyHistogram::bucketFor(std::uint64_t value) {
+    if (value < static_cast<std::uint64_t>(subBuckets)) {
+        return static_cast<int>(value);  // Малі значення зберігаються точно
+    }
+    int shift = 63 - __builtin_clzll(value) - subBits;
+    return (shift + 1) * subBuckets + static_cast<int>((value >> shift) & (subBuckets - 1));
+}
+
+std::uint64_t LatencyHistogram::bucketUpper(int bucket) {
+    if (bucket < subBuckets) {
+        return static_cast<std::uint64_t>(bucket);
+    }
+    int shift = bucket / subBuckets - 1;
+    std::uint64_t lower = static_cast<std::uint64_t>(subBuckets + bucket % subBuckets) << shift;
+    return lower + ((std::uint64_t(1) << shift) - 1);
+}
+
+void LatencyHistogram::record(std::uint64_t value) {
+    ++counts[bucketFor(value)];
+    ++total;
+    sum += value;
+    maxValue = std::max(maxValue, value);
+}
+
+std::uint64_t LatencyHistogram::percentile(double fraction) const {
+    std::uint64_t rank = static_cast<std::uint64_t>(std::ceil(fraction * static_cast<double>(total)));
+    std::uint64_t seen = 0;
+    for (int bucket = 0; bucket < bucketCount; ++bucket) {
+        seen += counts[bucket];
+        if (seen >= rank && seen > 0) {
+            return std::min(bucketUpper(bucket), maxValue);
+        }
+    }
+    return maxValue;
+}
+
+// Операції, для яких збираються лічильники
+enum class MetricOperation : std::uint8_t {
+    Add,
+    Delete,
+    Filter,
+    Sort,
+    Save,
+    Load
+};
+
+// Лічильники менеджера завдань
+class TaskMetrics {
+public:
+    static constexpr std::size_t operationCount = 6;
+
+private:
+    LatencyHistogram latencies[operationCount];    // Тривалості викликів, нс
+    std::uint64_t allocations[operationCount] = {};  // Виділення пам'яті під час викликів
+
+public:
+    std::uint64_t bytesParsed = 0;    // Обсяг завантажених файлів
+    std::uint64_t linesRejected = 0;  // Некоректні рядки у завантажених файлах
+
+    // Записує один виклик операції
+    void record(MetricOperation operation, std::uint64_t nanoseconds, std::uint64_t allocationDelta) {
+        latencies[static_cast<std::size_t>(operation)].record(nanoseconds);
+        allocations[static_cast<std::size_t>(operation)] += allocationDelta;
+    }
+
+    // Виводить лічильники таблицею або одним JSON-об'єктом
+    void write(std::ostream& os, bool json) const;
+};
+
+void TaskMetrics::write(std::ostream& os, bool json) const {
+    static const char* names[operationCount] = {"add", "delete", "filter", "sort", "save", "load"};
+    std::ios::fmtflags flags = os.flags();
+    os << std::fixed << std::setprecision(1);
+    if (json) {
+        os << "{\"operations\":{";
+    } else {
+        os << std::left << std::setw(10) << "operation" << std::right << std::setw(12) << "count" << std::setw(12) << "mean us"
+           << std::setw(12) << "p50 us" << std::setw(12) << "p90 us" << std::setw(12) << "p99 us" << std::setw(12) << "max us";
+        if (countsAllocations) {
+            os << std::setw(14) << "allocations";  // Стовпчик є лише у збиранні з підрахунком виділень
+        }
+        os << "\n";
+    }
+    for (std::size_t i = 0; i < operationCount; ++i) {
+        const LatencyHistogram& latency = latencies[i];
+        double values[] = {latency.mean() / 1000.0, latency.percentile(0.5) / 1000.0, latency.percentile(0.9) / 1000.0,
+                           latency.percentile(0.99) / 1000.0, latency.max() / 1000.0};
+        if (json) {
+            static const char* keys[] = {"mean_us", "p50_us", "p90_us", "p99_us", "max_us"};
+            os << (i ? "," : "") << "\"" << names[i] << "\":{\"count\":" << latency.count();
+            for (std::size_t k = 0; k < 5; ++k) {
+                os << ",\"" << keys[k] << "\":" << values[k];
+            }
+            if (countsAllocations) {
+                os << ",\"allocations\":" << allocations[i];
+            }
+            os << "}";
+        } else {
+            os << std::left << std::setw(10) << names[i] << std::right << std::setw(12) << latency.count();
+            for (double value : values) {
+                os << std::setw(12) << value;
+            }
+            if (countsAllocations) {
+                os << std::setw(14) << allocations[i];
+            }
+            os << "\n";
+        }
+    }
+    if (json) {
+        os << "},\"bytes_parsed\":" << bytesParsed << ",\"lines_rejected\":" << linesRejected << "}\n";
+    } else {
+        os << "bytes parsed: " << bytesParsed << "\nlines rejected: " << linesRejected << "\n";
+    }
+    os.flags(flags);
+}
+
+// Вимірює один виклик операції від створення до знищення об'єкта
+class MetricsScope {
+    TaskMetrics& metrics;
+    MetricOperation operation;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::size_t allocationsBefore = allocationsSoFar();
+
+public:
+    MetricsScope(TaskMetrics& metrics, MetricOperation operation) : metrics(metrics), operation(operation) {}
+    ~MetricsScope() {
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        metrics.record(operation, static_cast<std::uint64_t>(elapsed.count()), allocationsSoFar() - allocationsBefore);
+    }
+};
+
+#if TASK_METRICS
+#define TASK_METRICS_SCOPE(operation) MetricsScope metricsScope(metrics, MetricOperation::operation)
+#define TASK_METRICS_ADD(counter, value) (metrics.counter += (value))
+#else
+#define TASK_METRICS_SCOPE(operation) ((void)0)
+#define TASK_METRICS_ADD(counter, value) ((void)0)
+#endif
+
+// Клас для управління завданнями
+class TaskMananger {
+    TaskArena arena;  // Арена для завдань, їхніх рядків і вузлів списку та індексу дедлайнів
+    std::vector<std::unique_ptr<TaskArena>> loaderArenas;  // Арени потоків паралельного завантаження та знімків
+    std::pmr::list<Task*> tasks{arena.resource()};  // Список вказівників на об'єкти завдань
+    // Найстаріше та наймолодше завдання з назвою; решта зв'язані через Task::nextSameName
+    struct NameChain {
+        Task* oldest = nullptr;
+        Task* newest = nullptr;
+    };
+    mutable StringHashMap<NameChain> nameIndex;  // Індекс за назвою (завдання у порядку додавання)
+    DuplicatePolicy duplicatePolicy = DuplicatePolicy::Keep;  // Політика для однакових назв
+    mutable std::pmr::map<std::pair<std::int32_t, std::uint64_t>, Task*> deadlineIndex{arena.resource()};  // Індекс за (днем дедлайну, номером)
+    // Індекс важливих завдань за (пріоритетом за спаданням, днем дедлайну, номером) — найтерміновіші першими
+    mutable std::pmr::map<std::tuple<std::int64_t, std::int32_t, std::uint64_t>, Task*> urgencyIndex{arena.resource()};
+    // Чи побудовані індекс назв та індекси дедлайнів і терміновості. Після відновлення знімка вони будуються
+    // під час першого звернення, тож const-запити змінюють їх; ConcurrentTaskMananger знімків не завантажує,
+    // і його сегменти мають індекси завжди
+    mutable bool namesIndexed = true;
+    mutable bool orderIndexed = true;
+    TextIndex textIndex;  // Інвертований індекс слів з назв та описів
+    bool textIndexed = false;  // Чи побудовано індекс слів (будується під час першого пошуку, далі оновлюється)
+    std::uint64_t nextId = 0;  // Номер для наступного доданого завдання
+    TaskStore store;  // Стовпчикова копія завдань для швидкого перегляду та фільтрації
+    unsigned loadThreads = 1;  // Кількість потоків для розбору файлу під час завантаження
+    bool verbose = true;  // Чи виводити повідомлення про успішні операції
+    std::unique_ptr<TaskJournal> journal;  // Журнал змін (nullptr, якщо не відкрито)
+    std::string journalBase;  // Шлях до журналу та знімка без розширення
+    static constexpr std::size_t journalCompactionMin = 10000;  // Журнал коротший за це не ущільнюється
+#if TASK_METRICS
+    // Лічильники операцій; оновлюються й у const-методах виведення, які ConcurrentTaskMananger не викликає
+    mutable TaskMetrics metrics;
+#endif
+
+    // Перебудовує стовпчикове сховище у поточному порядку списку
+    void rebuildStore();
+
+    // Повертає живі завдання за зростанням номерів (у порядку додавання)
+    std::vector<Task*> tasksById() const;
+
+    // Будує індекс назв, якщо його відкладено
+    void buildNameIndex() const;
+
+    // Будує індекси дедлайнів і терміновості, якщо їх відкладено
+    void buildOrderIndexes() const;
+
+
+    // Розбирає текст паралельно частинами та додає завдання у початковому порядку
+    void loadParallel(std::string_view text, unsigned threads, bool escaped, LoadReport& report);
+
+    // Записує всі завдання у звіт
+    void writeTasks(ReportWriter& writer) const;
+
+    // Записує завдання у бінарний знімок
+    void saveSnapshot(std::ofstream& file) const;
+
+    // Додає завдання з бінарного знімка
+    // (restoring — відновлення стану журналу: номери завдань повторюють їхній вік, а не порядок записів)
+    void loadSnapshot(std::string_view contents, LoadReport& report, bool restoring = false);
+    
+    // Виводить зведення завантаження: пропущені дублікати та некоректні рядки
+    void reportLoad(const LoadReport& report) const;
+
+    // Повертає 32-бітний ключ рядка сховища для поля (менший ключ — вище у списку)
+    std::uint32_t sortKey(std::uint32_t row, SortField field) const;
+
+    // Прибирає завдання з індексу за назвою; повертає його номер за віком серед завдань з цією назвою
+    std::size_t unindexName(Task* task);
+
+    // Скидає групу записів журналу на диск, якщо настав час (force — завжди),
+    // і ущільнює журнал, коли в ньому більше записів, ніж завдань
+    void commitJournal(bool force);
+
+    // Відтворює записи журналу; validBytes та validRecords — неушкоджена частина файлу
+    void replayJournal(std::string_view contents, std::uint64_t snapshotHash, std::size_t& validBytes, std::size_t& validRecords);
+
+    // Видаляє завдання зі списку, індексу та пам'яті
+    void removeTask(Task* task);
+    
+    // Видаляє count завдань, позначених removing, одним проходом списку
+    void removeMarked(std::size_t count);
+    
+    // Застосовує політику дублікатів до нового завдання; повертає false, якщо завдання знищено
+    bool admitTask(Task* task);
+    
+    // Додає завдання до списку, індексу назв, сховища, індексу слів і журналу (без індексів дедлайнів)
+    void appendTask(Task* task);
+
+public:
+    ~TaskMananger();  // Деструктор для очищення пам'яті
+
+    // Додає нове завдання, створене через new або createTask, і бере його у володіння
+    // (повертає false, якщо завдання пропущено через політику дублікатів)
+    bool addTask(Task* task);
+    
+    // Додає групу завдань з одним резервуванням місця та одним оновленням індексів дедлайнів
+    // (політика дублікатів діє як для addTask); повертає кількість доданих
+    std::size_t addTasks(const std::vector<Task*>& batch);
+    
+    // Видаляє завдання за його назвою (найстаріше, якщо назва повторюється)
+    bool deleteTask(std::string_view taskName);
+    
+    // Видаляє за кожною назвою найстаріше ще не видалене завдання одним проходом; повертає кількість видалених
+    std::size_t deleteTasks(const std::vector<std::string_view>& taskNames);
+    
+    // Видаляє всі завдання, що задовольняють умову, одним проходом; повертає кількість видалених
+    std::size_t deleteWhere(const TaskFilter& filter);
+    
+    // Шукає завдання за назвою (найстаріше, якщо назва повторюється), або nullptr
+    Task* findTask(std::string_view taskName) const;
+    
+    // Повертає завдання з дедлайном у межах [from, to] у порядку дедлайнів
+    std::vector<Task*> tasksDueBetween(const std::tm& from, const std::tm& to) const;
+    
+    // Повертає завдання з дедлайном не раніше from у порядку дедлайнів
+    std::vector<Task*> tasksDueFrom(const std::tm& from) const;
+    
+    // Повертає n найближчих завдань з дедлайном не раніше сьогоднішнього дня
+    std::vector<Task*> nextDue(std::size_t n) const;
+    
+    // Повертає k найтерміновіших важливих завдань (більший пріоритет, потім раніший дедлайн) за O(k)
+    std::vector<Task*> topK(std::size_t k) const;
+    
+    // Повертає завдання, що задовольняють умову (перегляд стовпчикового сховища)
+    std::vector<Task*> findTasks(const TaskFilter& filter) const;
+    
+    // Шукає завдання за словами з назви та опису (синтаксис запиту — TextIndex::search) з додатковою умовою
+    std::vector<Task*> searchTasks(std::string_view query, const TaskFilter& filter = TaskFilter());
+    
+    // Рахує завдання, що задовольняють умову
+    std::size_t countTasks(const TaskFilter& filter) const { return store.count(filter); }
+    
+    // Повертає стовпчикове сховище завдань
+    const TaskStore& columns() const { return store; }
+    
+    // Повертає список завдань
+    const std::pmr::list<Task*>& getTasks() const { return tasks; }
+    
+    // Повертає кількість завдань
+    std::size_t size() const { return store.size(); }
+    
+    // Створює завдання з розібраного рядка в арені менеджера (передається далі в addTask)
+    Task* createTask(const ParsedTask& parsed) { return arena.create(parsed); }
+    
+    // Видаляє всі завдання; пам'ять арени звільняється цілими блоками
+    void clear();
+    
+    // Встановлює кількість потоків для завантаження файлів (0 — за кількістю ядер)
+    void setLoadThreads(unsigned count);
+    
+    // Вмикає або вимикає повідомлення про успішні операції
+    void setVerbose(bool enabled) { verbose = enabled; }
+    
+    // Встановлює політику для завдань з однаковими назвами
+    void setDuplicatePolicy(DuplicatePolicy policy) { duplicatePolicy = policy; }
+    
+    // Виводить усі завдання
+    void printTasks(ReportFormat format = ReportFormat::Table) const;
+    
+    // Виводить лише вибрані завдання у заданому порядку
+    void printTasks(const std::vector<Task*>& selection, ReportFormat format = ReportFormat::Table) const;
+    
+    // Записує всі завдання у файл звіту заданого формату; повертає false, якщо запис не вдався
+    bool exportTasks(const std::string& fileName, ReportFormat format) const;
+    
+    // Фільтрує завдання за дедлайном
+    void filterTasksByDeadline(const std::tm& deadline, ReportFormat format = ReportFormat::Table) const;
+    
+    // Зберігає завдання у файл (текстовий або бінарний знімок для розширення .tsnap); повертає false, якщо запис не вдався
+    bool saveToFile(const std::string& fileName) const;
+    
+    // Завантажує завдання з файлу (формат визначається автоматично); некоректні рядки пропускаються і потрапляють у звіт
+    LoadReport loadFromFile(const std::string& fileName);
+    
+    // Завантажує лише завдання, що задовольняють запит, читаючи файл потоком (пам'ять — лише під збіги)
+    LoadReport loadMatching(const std::string& fileName, const TaskQuery& query);
+    
+    // Сортує завдання за важливістю (при однаковій важливості — за дедлайном)
+    void sortByImportance();
+    
+    // Стабільно сортує завдання за двома ключами (при однакових ключах зберігається поточний порядок)
+    void sortTasks(SortField primary, SortField secondary = SortField::None);
+    
+    // Відкриває журнал змін baseName.journal: завантажує знімок baseName.tsnap, відтворює журнал,
+    // а далі дописує до журналу кожну зміну; повертає false, якщо журнал не відкрився
+    bool openJournal(const std::string& baseName);
+    
+    // Скидає на диск усі записи журналу, що ще чекають у буфері
+    void syncJournal() { commitJournal(true); }
+    
+    // Записує всі завдання у новий знімок і починає порожній журнал; повертає false, якщо стискання не вдалося
+    bool compactJournal();
+    
+    // Скидає журнал на диск і закриває його
+    void closeJournal();
+    
+    // Виводить лічильники операцій таблицею або JSON
+    void writeMetrics(std::ostream& os, bool json) const;
+};
+
+// Деструктор очищує пам'ять від завдань
+TaskMananger::~TaskMananger() {
+    for (Task* task : tasks) {
+        if (!task->pooled) {
+            delete task;  // Завдання, створені через new, видаляються по одному
+        }
+    }
+    // Завдання в аренах звільняються разом з аренами
+}
+
+// Видаляє всі завдання
+void TaskMananger::clear() {
+    if (journal) {
+        journal->logClear();
+    }
+    for (Task* task : tasks) {
+        if (!task->pooled) {
+            delete task;
+        }
+    }
+    tasks.clear();
+    deadlineIndex.clear();
+    urgencyIndex.clear();
+    orderIndexed = true;  // Порожні індекси вже побудовані
+    textIndex.clear();
+    nameIndex.clear();
+    namesIndexed = true;
+    store.clear();
+    loaderArenas.clear();
+    arena.release();  // Рядки та завдання в арені звільняються цілими блоками
+    commitJournal(false);
+}
+
+// Прибирає завдання з індексу за назвою
+std::size_t TaskMananger::unindexName(Task* task) {
+    buildNameIndex();
+    NameChain* sameName = nameIndex.find(task->getName());
+    if (!sameName) {
+        return 0;
+    }
+    std::size_t occurrence = 0;
+    Task* previous = nullptr;
+    for (Task* current = sameName->oldest; current && current != task; current = current->nextSameName) {
+        previous = current;
+        ++occurrence;
+    }
+    (previous ? previous->nextSameName : sameName->oldest) = task->nextSameName;
+    if (sameName->newest == task) {
+        sameName->newest = previous;
+    }
+    task->nextSameName = nullptr;
+    if (!sameName->oldest) {
+        nameIndex.erase(task->getName());  // Ключ ще вказує на назву цього завдання
+    } else {
+        nameIndex.rebind(sameName->oldest->getName());  // Ключ тепер вказує на назву іншого завдання
+    }
+    return occurrence;
+}
+
+// Видаляє завдання зі списку, індексу та пам'яті
+void TaskMananger::removeTask(Task* task) {
+    std::size_t occurrence = unindexName(task);
+    if (journal) {
+        journal->logDelete(task->getName(), occurrence);  // При відтворенні видаляється те саме за віком завдання з цією назвою
+    }
+    if (textIndexed) {
+        textIndex.remove(task->id, task->getName(), task->getDescription());
+    }
+    if (orderIndexed) {
+        deadlineIndex.erase({task->deadlineDay, task->id});
+    }
+    if (orderIndexed && kindInfo(store.kind(task->row)).hasPriority) {
+        urgencyIndex.erase({-static_cast<std::int64_t>(store.priority(task->row)), task->deadlineDay, task->id});
+    }
+    store.remove(task->row);
+    tasks.erase(task->position);
+    TaskArena::destroy(task);
+
+    if (store.needsCompaction()) {
+        rebuildStore();  // Звільняємо місце, яке займали видалені завдання
+    }
+    commitJournal(false);
+}
+
+// Видаляє позначені завдання одним проходом списку. Індекси дедлайнів і терміновості
+// теж проходяться один раз, якщо видаляється помітна частка завдань; інакше записи вилучаються окремо
+void TaskMananger::removeMarked(std::size_t count) {
+    if (count == 0) {
+        return;
+    }
+    const bool sweepIndexes = count * 16 >= deadlineIndex.size();
+    std::vector<Task*> removed;
+    removed.reserve(count);
+    for (auto it = tasks.begin(); it != tasks.end() && removed.size() < count;) {
+        Task* task = *it;
+        if (!task->removing) {
+            ++it;
+            continue;
+        }
+        std::size_t occurrence = unindexName(task);
+        if (journal) {
+            journal->logDelete(task->getName(), occurrence);
+        }
+        if (textIndexed) {
+            textIndex.remove(task->id, task->getName(), task->getDescription());
+        }
+        if (orderIndexed && !sweepIndexes) {
+            deadlineIndex.erase({task->deadlineDay, task->id});
+            if (kindInfo(store.kind(task->row)).hasPriority) {
+                urgencyIndex.erase({-static_cast<std::int64_t>(store.priority(task->row)), task->deadlineDay, task->id});
+            }
+        }
+        store.remove(task->row);
+        it = tasks.erase(it);
+        removed.push_back(task);
+    }
+    if (orderIndexed && sweepIndexes) {
+        for (auto it = deadlineIndex.begin(); it != deadlineIndex.end();) {
+            it = it->second->removing ? deadlineIndex.erase(it) : std::next(it);
+        }
+        for (auto it = urgencyIndex.begin(); it != urgencyIndex.end();) {
+            it = it->second->removing ? urgencyIndex.erase(it) : std::next(it);
+        }
+    }
+    for (Task* task : removed) {
+        TaskArena::destroy(task);
+    }
+
+    if (store.needsCompaction()) {
+        rebuildStore();  // Звільняємо місце, яке займали видалені завдання
+    }
+    commitJournal(false);
+}
+
+// Перебудовує стовпчикове сховище у поточному порядку списку
+void TaskMananger::rebuildStore() {
+    std::vector<std::uint32_t> order;
+    order.reserve(tasks.size());
+    for (Task* task : tasks) {
+        order.push_back(task->row);
+    }
+    store.reorder(order);
+
+    std::uint32_t row = 0;
+    for (Task* task : tasks) {
+        task->row = row++;
+    }
+}
+
+// Вставляє в індекс записи, впорядковані за ключем. Позиція кожного наступного запису шукається
+// від попереднього: для порожнього індексу чи записів після наявних це O(1) на запис
+template <typename Index, typename Entry>
+void insertSorted(Index& index, const std::vector<Entry>& entries) {
+    auto hint = entries.empty() ? index.end() : index.lower_bound(entries.front().first);
+    for (const Entry& entry : entries) {
+        int steps = 0;
+        while (hint != index.end() && hint->first < entry.first && ++steps < 8) {
+            ++hint;
+        }
+        if (hint != index.end() && hint->first < entry.first) {
+            hint = index.lower_bound(entry.first);  // Далеко від попереднього — звичайний пошук
+        }
+        hint = std::next(index.emplace_hint(hint, entry.first, entry.second));
+    }
+}
+
+// Будує індекси дедлайнів і терміновості, якщо їх відкладено
+void TaskMananger::buildOrderIndexes() const {
+    if (orderIndexed) {
+        return;
+    }
+    std::vector<std::pair<std::pair<std::int32_t, std::uint64_t>, Task*>> deadlineEntries;
+    std::vector<std::pair<std::tuple<std::int64_t, std::int32_t, std::uint64_t>, Task*>> urgencyEntries;
+    deadlineEntries.reserve(store.size());
+    for (Task* task : tasksById()) {
+        deadlineEntries.emplace_back(std::make_pair(task->deadlineDay, task->id), task);
+        if (kindInfo(store.kind(task->row)).hasPriority) {
+            urgencyEntries.emplace_back(std::make_tuple(-static_cast<std::int64_t>(store.priority(task->row)), task->deadlineDay, task->id), task);
+        }
+    }
+    // Номери зростають, тож стабільне сортування лише за днем дає порядок (день, номер)
+    std::stable_sort(deadlineEntries.begin(), deadlineEntries.end(), [](const auto& a, const auto& b) {
+        return a.first.first < b.first.first;
+    });
+    insertSorted(deadlineIndex, deadlineEntries);
+    std::sort(urgencyEntries.begin(), urgencyEntries.end());
+    insertSorted(urgencyIndex, urgencyEntries);
+    orderIndexed = true;
+}
+
+// Повертає живі завдання за зростанням номерів (у порядку додавання)
+std::vector<Task*> TaskMananger::tasksById() const {
+    std::vector<Task*> result;
+    result.reserve(store.size());
+    std::uint64_t firstId = nextId;
+    for (std::uint32_t row = 0; row < store.rows(); ++row) {
+        if (!store.isRemoved(row)) {
+            result.push_back(store.owner(row));
+            firstId = std::min(firstId, result.back()->id);
+        }
+    }
+    auto olderFirst = [](const Task* a, const Task* b) { return a->id < b->id; };
+    if (std::is_sorted(result.begin(), result.end(), olderFirst)) {
+        return result;
+    }
+    if (nextId - firstId > 2 * result.size()) {
+        std::sort(result.begin(), result.end(), olderFirst);  // Після багатьох видалень номери розріджені
+        return result;
+    }
+    // Номери майже без пропусків: кожне завдання стає на місце свого номера без порівнянь
+    std::vector<Task*> byId(static_cast<std::size_t>(nextId - firstId), nullptr);
+    for (Task* task : result) {
+        byId[static_cast<std::size_t>(task->id - firstId)] = task;
+    }
+    byId.erase(std::remove(byId.begin(), byId.end(), nullptr), byId.end());
+    return byId;
+}
+
+// Будує індекс назв, якщо його відкладено
+void TaskMananger::buildNameIndex() const {
+    if (namesIndexed) {
+        return;
+    }
+    // Ланцюжки назв ідуть за віком, тож завдання додаються за зростанням номерів, як їх додавав би appendTask
+    std::vector<Task*> byId = tasksById();
+    nameIndex.reserve(byId.size());
+    for (Task* task : byId) {
+        bool inserted = false;
+        NameChain& sameName = nameIndex.insert(task->getName(), inserted);
+        (sameName.newest ? sameName.newest->nextSameName : sameName.oldest) = task;
+        sameName.newest = task;
+        task->nextSameName = nullptr;
+    }
+    namesIndexed = true;
+}
+
+// Застосовує політику дублікатів до нового завдання
+bool TaskMananger::admitTask(Task* task) {
+    if (duplicatePolicy == DuplicatePolicy::Keep || !findTask(task->getName())) {  // Keep не шукає назву двічі
+        return true;
+    }
+    if (duplicatePolicy == DuplicatePolicy::Skip) {
+        TaskArena::destroy(task);  // Завдання з такою назвою вже є
+        return false;
+    }
+    if (duplicatePolicy == DuplicatePolicy::Replace) {
+        while (Task* old = findTask(task->getName())) {
+            removeTask(old);  // Видаляємо всі завдання з такою ж назвою
+        }
+    }
+    return true;
+}
+
+// Додає завдання до списку, індексу назв, сховища, індексу слів і журналу
+void TaskMananger::appendTask(Task* task) {
+    task->position = tasks.insert(tasks.end(), task);  // Додаємо завдання до кінця списку
+
+    // Оновлюємо індекс за назвою: завдання стає в кінець ланцюжка своєї назви
+    // (відкладений індекс підхопить завдання, коли його буде побудовано)
+    if (namesIndexed) {
+        bool inserted = false;
+        NameChain& sameName = nameIndex.insert(task->getName(), inserted);
+        (sameName.newest ? sameName.newest->nextSameName : sameName.oldest) = task;
+        sameName.newest = task;
+    }
+
+    task->id = nextId++;
+
+    // Оновлюємо стовпчикове сховище
+    task->row = store.append(task->kind(), task->priority(), task->deadlineDay, task);
+
+    if (textIndexed) {
+        textIndex.add(task->id, task, task->getName(), task->getDescription());  // Оновлюємо індекс слів
+    }
+
+    if (journal) {
+        journal->logAdd(store.kind(task->row), store.priority(task->row), task->deadlineDay, task->getName(), task->getDescription());
+    }
+}
+
+// Додає нове завдання до списку
+bool TaskMananger::addTask(Task* task) {
+    TASK_METRICS_SCOPE(Add);
+    if (!admitTask(task)) {
+        return false;
+    }
+    appendTask(task);
+
+    if (orderIndexed) {  // Відкладені індекси підхоплять завдання, коли їх буде побудовано
+        deadlineIndex.emplace_hint(deadlineIndex.end(), std::make_pair(task->deadlineDay, task->id), task);  // Оновлюємо індекс за дедлайном
+        if (kindInfo(store.kind(task->row)).hasPriority) {
+            urgencyIndex.emplace(std::make_tuple(-static_cast<std::int64_t>(store.priority(task->row)), task->deadlineDay, task->id), task);  // Оновлюємо індекс терміновості
+        }
+    }
+    commitJournal(false);
+    return true;
+}
+
+// Додає групу завдань
+std::size_t TaskMananger::addTasks(const std::vector<Task*>& batch) {
+    TASK_METRICS_SCOPE(Add);
+    store.reserve(store.rows() + batch.size());
+    if (namesIndexed) {
+        nameIndex.reserve(nameIndex.size() + batch.size());
+    }
+
+    // Записи індексів дедлайнів і терміновості збираються й вставляються впорядкованими наприкінці
+    std::vector<std::pair<std::pair<std::int32_t, std::uint64_t>, Task*>> deadlineEntries;
+    std::vector<std::pair<std::tuple<std::int64_t, std::int32_t, std::uint64_t>, Task*>> urgencyEntries;
+    deadlineEntries.reserve(batch.size());
+    auto flushIndexes = [&]() {
+        // Номери в групі зростають, тож стабільне сортування лише за днем дає порядок (день, номер)
+        std::stable_sort(deadlineEntries.begin(), deadlineEntries.end(), [](const auto& a, const auto& b) {
+            return a.first.first < b.first.first;
+        });
+        insertSorted(deadlineIndex, deadlineEntries);
+        deadlineEntries.clear();
+        std::sort(urgencyEntries.begin(), urgencyEntries.end());
+        insertSorted(urgencyIndex, urgencyEntries);
+        urgencyEntries.clear();
+    };
+
+    std::size_t added = 0;
+    for (Task* task : batch) {
+        if (duplicatePolicy == DuplicatePolicy::Replace && findTask(task->getName())) {
+            flushIndexes();  // Заміна може видалити завдання з цієї ж групи — воно вже має бути в індексах
+        }
+        if (!admitTask(task)) {
+            continue;
+        }
+        appendTask(task);
+        ++added;
+        if (!orderIndexed) {
+            continue;  // Завдання потрапить в індекси, коли їх буде побудовано
+        }
+        deadlineEntries.emplace_back(std::make_pair(task->deadlineDay, task->id), task);
+        if (kindInfo(store.kind(task->row)).hasPriority) {
+            urgencyEntries.emplace_back(std::make_tuple(-static_cast<std::int64_t>(store.priority(task->row)), task->deadlineDay, task->id), task);
+        }
+    }
+    flushIndexes();
+    commitJournal(false);
+    return added;
+}
+
+// Видаляє завдання за його назвою
+bool TaskMananger::deleteTask(std::string_view taskName) {
+    TASK_METRICS_SCOPE(Delete);
+    Task* task = findTask(taskName);
+    if (!task) {
+        return false;  // Повертаємо false, якщо завдання не знайдено
+    }
+    removeTask(task);
+    return true;
+}
+
+// Видаляє завдання за назвами
+std::size_t TaskMananger::deleteTasks(const std::vector<std::string_view>& taskNames) {
+    TASK_METRICS_SCOPE(Delete);
+    std::size_t count = 0;
+    buildNameIndex();
+    for (std::string_view taskName : taskNames) {
+        NameChain* sameName = nameIndex.find(taskName);
+        if (!sameName) {
+            continue;
+        }
+        for (Task* task = sameName->oldest; task; task = task->nextSameName) {
+            if (!task->removing) {
+                task->removing = true;  // Найстаріше з ще не позначених
+                ++count;
+                break;
+            }
+        }
+    }
+    removeMarked(count);
+    return count;
+}
+
+// Видаляє всі завдання, що задовольняють умову
+std::size_t TaskMananger::deleteWhere(const TaskFilter& filter) {
+    TASK_METRICS_SCOPE(Delete);
+    std::vector<std::uint32_t> rows = store.select(filter);
+    for (std::uint32_t row : rows) {
+        store.owner(row)->removing = true;
+    }
+    removeMarked(rows.size());
+    return rows.size();
+}
+
+// Шукає завдання за назвою
+Task* TaskMananger::findTask(std::string_view taskName) const {
+    buildNameIndex();
+    const NameChain* sameName = nameIndex.find(taskName);
+    return sameName ? sameName->oldest : nullptr;
+}
+
+// Повертає завдання з дедлайном у межах [from, to]
+std::vector<Task*> TaskMananger::tasksDueBetween(const std::tm& from, const std::tm& to) const {
+    buildOrderIndexes();
+    std::vector<Task*> result;
+    std::int32_t toDay = dayNumber(to);
+    for (auto it = deadlineIndex.lower_bound({dayNumber(from), 0}); it != deadlineIndex.end() && it->first.first <= toDay; ++it) {
+        result.push_back(it->second);
+    }
+    return result;
+}
+
+// Повертає завдання з дедлайном не раніше from
+std::vector<Task*> TaskMananger::tasksDueFrom(const std::tm& from) const {
+    buildOrderIndexes();
+    std::vector<Task*> result;
+    for (auto it = deadlineIndex.lower_bound({dayNumber(from), 0}); it != deadlineIndex.end(); ++it) {
+        result.push_back(it->second);
+    }
+    return result;
+}
+
+// Повертає n найближчих завдань, починаючи з сьогоднішнього дня
+std::vector<Task*> TaskMananger::nextDue(std::size_t n) const {
+    buildOrderIndexes();
+    std::vector<Task*> result;
+    for (auto it = deadlineIndex.lower_bound({currentDay(), 0}); it != deadlineIndex.end() && result.size() < n; ++it) {
+        result.push_back(it->second);
+    }
+    return result;
+}
+
+// Повертає k найтерміновіших важливих завдань
+std::vector<Task*> TaskMananger::topK(std::size_t k) const {
+    buildOrderIndexes();
+    std::vector<Task*> result;
+    result.reserve(std::min(k, urgencyIndex.size()));
+    for (auto it = urgencyIndex.begin(); it != urgencyIndex.end() && result.size() < k; ++it) {
+        result.push_back(it->second);
+    }
+    return result;
+}
+
+// Повертає завдання, що задовольняють умову
+std::vector<Task*> TaskMananger::findTasks(const TaskFilter& filter) const {
+    std::vector<Task*> result;
+    for (std::uint32_t row : store.select(filter)) {
+        result.push_back(store.owner(row));
+    }
+    return result;
+}
+
+// Шукає завдання за словами та відбирає ті, що задовольняють умову
+std::vector<Task*> TaskMananger::searchTasks(std::string_view query, const TaskFilter& filter) {
+    if (!textIndexed) {
+        // Перший пошук будує індекс; записи додаються за зростанням номерів, як їх додавав би addTask
+        for (Task* task : tasksById()) {
+            textIndex.add(task->id, task, task->getName(), task->getDescription());
+        }
+        textIndexed = true;
+    }
+    std::vector<Task*> result = textIndex.search(query);
+    result.erase(std::remove_if(result.begin(), result.end(), [this, &filter](Task* task) {
+        return !filter.matches(store.kind(task->row), store.priority(task->row), store.deadlineDay(task->row));
+    }), result.end());
+    return result;
+}
+
+// Записує всі завдання у звіт зі стовпчикового сховища
+void TaskMananger::writeTasks(ReportWriter& writer) const {
+    writer.writeHeader();  // Додаємо заголовки стовпців
+    for (std::uint32_t row = 0; row < store.rows(); ++row) {
+        if (!store.isRemoved(row)) {
+            writer.writeRow(store.kind(row), store.priority(row), store.deadlineDay(row), store.name(row), store.description(row));
+        }
+    }
+}
+
+// Виводить усі завдання на екран
+void TaskMananger::printTasks(ReportFormat format) const {
+    if (tasks.empty() && format == ReportFormat::Table) {
+        std::cout << "There are no tasks.\n";  // Якщо немає завдань
+        return;
+    }
+    ReportWriter writer(STDOUT_FILENO, format);  // Рядки формуються у буфері і виводяться великими блоками
+    writeTasks(writer);
+}
+
+// Виводить лише вибрані завдання
+void TaskMananger::printTasks(const std::vector<Task*>& selection, ReportFormat format) const {
+    if (selection.empty() && format == ReportFormat::Table) {
+        std::cout << "There are no tasks.\n";
+        return;
+    }
+    ReportWriter writer(STDOUT_FILENO, format);
+    writer.writeHeader();
+    for (Task* task : selection) {
+        std::uint32_t row = task->row;
+        writer.writeRow(store.kind(row), store.priority(row), store.deadlineDay(row), store.name(row), store.description(row));
+    }
+}
+
+// Записує всі завдання у файл звіту
+bool TaskMananger::exportTasks(const std::string& fileName, ReportFormat format) const {
+    try {
+        int fd = ::open(fileName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);  // Відкриваємо файл для запису
+        if (fd < 0) {
+            throw std::runtime_error("Error: can't open file for writing");
+        }
+        bool written;
+        {
+            ReportWriter writer(fd, format);
+            writeTasks(writer);
+            writer.flush();
+            written = writer.good();
+        }
+        ::close(fd);
+        if (!written) {
+            throw std::runtime_error("Error: can't write file");
+        }
+        if (verbose) {
+            std::cout << "Successfully exported to file\n";
+        }
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Error occurred during export: " << e.what() << "\n";  // Якщо сталася помилка
+        return false;
+    }
+}
+
+// Фільтрує завдання за дедлайном (ті, що мають дедлайн після заданої дати), у порядку дедлайнів
+void TaskMananger::filterTasksByDeadline(const std::tm& deadline, ReportFormat format) const {
+    TASK_METRICS_SCOPE(Filter);
+    if (tasks.empty()) {
+        if (format == ReportFormat::Table) {
+            std::cout << "There are no tasks.\n";  // Якщо немає завдань
+        }
+        return;
+    }
+
+    std::int32_t fromDay = dayNumber(deadline);
+    ReportWriter writer(STDOUT_FILENO, format);
+
+    // Виводимо заголовок фільтрованих завдань
+    char date[32];
+    formatDay(fromDay, date);
+    writer.writeText("Filtered Tasks (on or after ");
+    writer.writeText(date);
+    writer.writeText("):\n");
+    writer.writeHeader();
+
+    // Індекс за дедлайном одразу дає завдання, що підходять
+    buildOrderIndexes();
+    bool found = false;  // Прапорець, що вказує, чи були знайдені завдання
+    for (auto it = deadlineIndex.lower_bound({fromDay, 0}); it != deadlineIndex.end(); ++it) {
+        std::uint32_t row = it->second->row;
+        writer.writeRow(store.kind(row), store.priority(row), store.deadlineDay(row), store.name(row), store.description(row));
+        found = true;  // Знайшли завдання
+    }
+
+    if (!found) {
+        writer.writeText("No tasks found with a deadline on or after the specified date.\n");  // Якщо не знайдено жодного
+    }
+}
+
+// Зберігає завдання до файлу
+bool TaskMananger::saveToFile(const std::string& fileName) const {
+    TASK_METRICS_SCOPE(Save);
+    try {
+        bool snapshot = isSnapshotFileName(fileName);
+        std::ofstream file(fileName, snapshot ? std::ios::out | std::ios::binary : std::ios::out);  // Відкриваємо файл для запису
+
+        if (!file.is_open()) {
+            throw std::runtime_error("Error: can't open file for writing");
+        }
+
+        if (snapshot) {
+            saveSnapshot(file);  // Записуємо бінарний знімок
+        } else {
+            // Заголовок потрібен, лише якщо якесь поле доведеться екранувати: інакше файл читають і старі версії
+            if (std::any_of(tasks.begin(), tasks.end(), [](const Task* task) {
+                    return needsEscaping(task->getName()) || needsEscaping(task->getDescription());
+                })) {
+                file << escapedFileHeader << "\n";
+            }
+
+            // Записуємо кожне завдання до файлу
+            for (Task* task : tasks) {
+                visitTask(*task, [&file](const auto& concrete) {
+                    constexpr TaskKindInfo info = kindInfo(std::decay_t<decltype(concrete)>::staticKind);
+                    file << info.name << "|";
+                    writeEscaped(file, concrete.getName());  // Символи '|' та переведення рядка екрануються
+                    file << "|";
+                    writeEscaped(file, concrete.getDescription());
+                    file << "|" << concrete.getDeadlineText();  // Кешований рядок дати
+                    if constexpr (info.hasPriority) {
+                        file << "|" << concrete.getPriority();  // Тип з пріоритетом дописує його полем
+                    }
+                    file << "\n";
+                });
+            }
+        }
+
+        if (!file) {
+            throw std::runtime_error("Error: can't write file");
+        }
+
+        if (verbose) {
+            std::cout << "Successfully saved to file\n";
+        }
+        file.close();  // Закриваємо файл
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Error occurred during file saving: " << e.what() << "\n";  // Якщо сталася помилка
+        return false;
+    }
+}
+
+// Записує завдання у бінарний знімок
+void TaskMananger::saveSnapshot(std::ofstream& file) const {
+    std::vector<SnapshotRecord> records;
+    records.reserve(store.size());
+    std::string strings;  // Блок рядків; однакові рядки записуються один раз
+    StringHashMap<std::uint64_t> written;
+
+    auto addString = [&strings, &written](std::string_view text) {
+        bool inserted = false;
+        std::uint64_t& offset = written.insert(text, inserted);  // Ключі вказують у сховище, яке не змінюється
+        if (inserted) {
+            offset = strings.size();
+            strings.append(text.data(), text.size());
+        }
+        return offset;
+    };
+
+    // Записи йдуть у порядку списку, а вік зберігається окремо: після сортування видалення
+    // за назвою з журналу має знайти те саме завдання, що й до перезапуску
+    std::vector<std::pair<std::uint64_t, std::uint32_t>> ids;  // (номер завдання, номер запису)
+    ids.reserve(store.size());
+    for (std::uint32_t row = 0; row < store.rows(); ++row) {
+        if (!store.isRemoved(row)) {
+            ids.emplace_back(store.owner(row)->id, static_cast<std::uint32_t>(ids.size()));
+        }
+    }
+    std::vector<std::uint32_t> ages(ids.size());
+    if (!std::is_sorted(ids.begin(), ids.end())) {
+        std::sort(ids.begin(), ids.end());
+    }
+    for (std::uint32_t age = 0; age < ids.size(); ++age) {
+        ages[ids[age].second] = age;
+    }
+
+    for (std::uint32_t row = 0; row < store.rows(); ++row) {
+        if (store.isRemoved(row)) {
+            continue;
+        }
+        SnapshotRecord record = {};
+        record.age = ages[records.size()];
+        record.nameOffset = addString(store.name(row));
+        record.nameLength = static_cast<std::uint32_t>(store.name(row).size());
+        record.descriptionOffset = addString(store.description(row));
+        record.descriptionLength = static_cast<std::uint32_t>(store.description(row).size());
+        record.deadlineDay = store.deadlineDay(row);
+        record.priority = store.priority(row);
+        record.kind = static_cast<std::uint8_t>(store.kind(row));
+        records.push_back(record);
+    }
+
+    SnapshotHeader header = {};
+    std::memcpy(header.magic, snapshotMagic, sizeof(snapshotMagic));
+    header.version = snapshotVersion;
+    header.recordSize = sizeof(SnapshotRecord);
+    header.taskCount = records.size();
+    header.stringBytes = strings.size();
+
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(records.data()), static_cast<std::streamsize>(records.size() * sizeof(SnapshotRecord)));
+    file.write(strings.data(), static_cast<std::streamsize>(strings.size()));
+}
+
+// Додає завдання з бінарного знімка
+void TaskMananger::loadSnapshot(std::string_view contents, LoadReport& report, bool restoring) {
+    SnapshotHeader header;
+    if (contents.size() < sizeof(header)) {
+        throw std::runtime_error("Error: truncated snapshot header");
+    }
+    std::memcpy(&header, contents.data(), sizeof(header));
+    if (header.version < snapshotOldestVersion || header.version > snapshotVersion || header.recordSize != sizeof(SnapshotRecord)) {
+        throw std::runtime_error("Error: unsupported snapshot version");
+    }
+    std::size_t available = contents.size() - sizeof(header);
+    if (header.taskCount > available / sizeof(SnapshotRecord) ||
+        header.stringBytes != available - header.taskCount * sizeof(SnapshotRecord)) {
+        throw std::runtime_error("Error: snapshot size does not match its header");
+    }
+
+    const char* records = contents.data() + sizeof(header);
+    std::string_view strings(records + header.taskCount * sizeof(SnapshotRecord), header.stringBytes);
+    // Записи діляться між потоками; кожен створює свої завдання в одному блоці власної арени,
+    // розмір якого відомий наперед з довжин рядків
+    const std::size_t count = static_cast<std::size_t>(header.taskCount);
+    const std::size_t minChunkRecords = 1 << 16;  // Невеликі знімки не варто ділити між потоками
+    const std::size_t threads = std::max<std::size_t>(1, std::min<std::size_t>(loadThreads, count / minChunkRecords));
+    struct ChunkResult {
+        std::vector<Task*> tasks;
+        std::vector<std::uint32_t> ages;  // Вік кожного завдання (лише для відновлення)
+        LoadReport report;
+        std::unique_ptr<TaskArena> arena;
+    };
+    std::vector<ChunkResult> results(threads);
+    auto createChunk = [&header, records, strings, count, threads, restoring, &results](std::size_t index) {
+        ChunkResult& result = results[index];
+        const std::size_t first = count * index / threads;
+        const std::size_t last = count * (index + 1) / threads;
+        SnapshotRecord record;
+        std::size_t blockSize = 1;  // Розмір блоку має бути ненульовим і для порожньої частини
+        for (std::size_t i = first; i < last; ++i) {
+            std::memcpy(&record, records + i * sizeof(SnapshotRecord), sizeof(record));  // Записи можуть бути не вирівняні
+            blockSize += TaskArena::taskBytes(std::min<std::size_t>(record.nameLength, strings.size()),
+                                              std::min<std::size_t>(record.descriptionLength, strings.size()));
+        }
+        result.arena.reset(new TaskArena(blockSize));
+        result.tasks.reserve(last - first);
+
+        ParsedTask parsed;
+        for (std::size_t i = first; i < last; ++i) {
+            std::memcpy(&record, records + i * sizeof(SnapshotRecord), sizeof(record));
+            if (record.nameOffset > strings.size() || record.nameLength > strings.size() - record.nameOffset ||
+                record.descriptionOffset > strings.size() || record.descriptionLength > strings.size() - record.descriptionOffset ||
+                record.kind >= taskKindCount) {
+                result.report.reject(i + 1, "corrupt snapshot record");  // Номер запису замість номера рядка
+                continue;
+            }
+            parsed.kind = static_cast<TaskKind>(record.kind);
+            parsed.name = strings.substr(record.nameOffset, record.nameLength);
+            parsed.description = strings.substr(record.descriptionOffset, record.descriptionLength);
+            parsed.deadlineDay = record.deadlineDay;
+            parsed.priority = record.priority;
+            result.tasks.push_back(result.arena->create(parsed));
+            if (restoring) {
+                result.ages.push_back(header.version >= 2 ? record.age : static_cast<std::uint32_t>(i));
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (std::size_t i = 1; i < threads; ++i) {
+        workers.emplace_back(createChunk, i);
+    }
+    createChunk(0);  // Першу частину створює поточний потік
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    // Зливаємо частини у порядку записів
+    std::vector<Task*> batch;
+    batch.reserve(count);
+    std::vector<std::pair<std::uint32_t, Task*>> byAge;  // (вік, завдання) для відновлення
+    byAge.reserve(restoring ? count : 0);
+    for (ChunkResult& result : results) {
+        batch.insert(batch.end(), result.tasks.begin(), result.tasks.end());
+        for (std::size_t i = 0; i < result.ages.size(); ++i) {
+            byAge.emplace_back(result.ages[i], result.tasks[i]);
+        }
+        for (const LoadError& error : result.report.errors) {
+            if (report.errors.size() < LoadReport::maxErrors) {
+                report.errors.push_back(error);
+            }
+        }
+        report.rejected += result.report.rejected;
+        loaderArenas.push_back(std::move(result.arena));  // Арена живе, поки живуть її завдання
+    }
+    if (!batch.empty()) {
+        // Індекси будуються під час першого звернення до них, а не під час відновлення
+        nameIndex.clear();
+        namesIndexed = false;
+        deadlineIndex.clear();
+        urgencyIndex.clear();
+        orderIndexed = false;
+    }
+    if (!restoring || std::is_sorted(byAge.begin(), byAge.end())) {
+        std::size_t added = addTasks(batch);  // Одне резервування на весь знімок
+        report.loaded += added;
+        report.duplicates += batch.size() - added;
+        return;
+    }
+
+    // Додаємо у порядку віку, щоб номери, ланцюжки назв та індекси були такими ж, як до збереження,
+    // а потім повертаємо список до порядку знімка. Під час відновлення журнал закритий, а політика — Keep,
+    // тож додаються всі завдання
+    std::stable_sort(byAge.begin(), byAge.end(), [](const auto& a, const auto& b) {
+        return a.first < b.first;
+    });
+    std::vector<Task*> oldestFirst;
+    oldestFirst.reserve(byAge.size());
+    for (const auto& entry : byAge) {
+        oldestFirst.push_back(entry.second);
+    }
+    report.loaded += addTasks(oldestFirst);
+    for (Task* task : batch) {
+        tasks.splice(tasks.end(), tasks, task->position);
+    }
+    rebuildStore();
+}
+
+// Встановлює кількість потоків для завантаження файлів
+void TaskMananger::setLoadThreads(unsigned count) {
+    if (count == 0) {
+        count = std::thread::hardware_concurrency();
+    }
+    loadThreads = count > 0 ? count : 1;
+}
+
+// Розбирає текст паралельно частинами та додає завдання у початковому порядку
+void TaskMananger::loadParallel(std::string_view text, unsigned threads, bool escaped, LoadReport& report) {
+    // Ділимо текст на частини по межах рядків
+    std::vector<std::string_view> chunks;
+    while (!text.empty()) {
+        std::size_t size = text.size() / (threads - chunks.size());
+        if (chunks.size() + 1 < threads && size < text.size()) {
+            std::size_t newline = text.find('\n', size);
+            size = newline == std::string_view::npos ? text.size() : newline + 1;
+        } else {
+            size = text.size();
+        }
+        chunks.push_back(text.substr(0, size));
+        text.remove_prefix(size);
+    }
+
+    // Кожен потік розбирає свою частину та створює завдання у власному буфері та власній арені
+    struct ChunkResult {
+        std::vector<Task*> tasks;
+        LoadReport report;
+        std::size_t lines = 0;
+        std::unique_ptr<TaskArena> arena;
+    };
+    std::vector<ChunkResult> results(chunks.size());
+    for (std::size_t i = 1; i < results.size(); ++i) {
+        results[i].arena.reset(new TaskArena());
+    }
+    auto parseChunk = [this, &chunks, &results, escaped](std::size_t index) {
+        ChunkResult& result = results[index];
+        TaskArena& target = result.arena ? *result.arena : arena;  // Перша частина — в арені менеджера
+        result.lines = parseTaskText(chunks[index], 1, escaped, result.report, [&result, &target](const ParsedTask& parsed) {
+            result.tasks.push_back(target.create(parsed));
+        }) - 1;
+    };
+
+    std::vector<std::thread> workers;
+    for (std::size_t i = 1; i < chunks.size(); ++i) {
+        workers.emplace_back(parseChunk, i);
+    }
+    if (!chunks.empty()) {
+        parseChunk(0);  // Першу частину розбирає поточний потік
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    // Зливаємо результати у початковому порядку рядків
+    std::size_t firstLine = 1;
+    for (ChunkResult& result : results) {
+        std::size_t added = addTasks(result.tasks);
+        report.loaded += added;
+        report.duplicates += result.tasks.size() - added;
+        for (const LoadError& error : result.report.errors) {
+            if (report.errors.size() < LoadReport::maxErrors) {
+                report.errors.push_back({firstLine + error.line - 1, error.message});
+            }
+        }
+        report.rejected += result.report.rejected;
+        firstLine += result.lines;
+        if (result.arena) {
+            loaderArenas.push_back(std::move(result.arena));  // Арена живе, поки живуть її завдання
+        }
+    }
+}
+
+// Завантажує завдання з файлу
+LoadReport TaskMananger::loadFromFile(const std::string& fileName) {
+    TASK_METRICS_SCOPE(Load);
+    LoadReport report;
+    try {
+        MappedFile file(fileName);  // Відображаємо файл у пам'ять
+        TASK_METRICS_ADD(bytesParsed, file.contents().size());
+
+        // Невеликі файли не варто ділити між потоками
+        const std::size_t minChunkSize = 1 << 20;
+        unsigned threads = static_cast<unsigned>(std::min<std::size_t>(loadThreads, file.contents().size() / minChunkSize));
+        const bool escaped = hasEscapedHeader(file.contents());
+        if (isSnapshot(file.contents())) {
+            loadSnapshot(file.contents(), report);  // Бінарний знімок не потребує розбору полів
+        } else if (threads > 1) {
+            loadParallel(file.contents(), threads, escaped, report);
+        } else {
+            // Рядки розбираються на місці; копіюються лише назва та опис нового завдання
+            std::vector<Task*> batch;
+            parseTaskText(file.contents(), 1, escaped, report, [this, &batch](const ParsedTask& parsed) {
+                batch.push_back(createTask(parsed));
+            });
+            std::size_t added = addTasks(batch);
+            report.loaded += added;
+            report.duplicates += batch.size() - added;
+        }
+
+        reportLoad(report);
+        if (verbose) {
+            std::cout << "Successfully loaded from file\n";
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error occurred during file loading: " << e.what() << "\n";  // Якщо сталася помилка
+        report.failed = true;
+    }
+    return report;
+}
+
+// Завантажує лише завдання, що задовольняють запит
+LoadReport TaskMananger::loadMatching(const std::string& fileName, const TaskQuery& query) {
+    TASK_METRICS_SCOPE(Load);
+    LoadReport report;
+    try {
+        std::vector<Task*> batch;
+        report = streamTaskFile(fileName, query, [this, &batch](const ParsedTask& parsed) {
+            batch.push_back(createTask(parsed));
+        });
+        TASK_METRICS_ADD(bytesParsed, report.bytesRead);
+        std::size_t added = addTasks(batch);
+        report.loaded += added;
+        report.duplicates += batch.size() - added;
+
+        reportLoad(report);
+        if (verbose) {
+            std::cout << "Loaded " << report.loaded << " matching tasks from file\n";
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error occurred during file loading: " << e.what() << "\n";
+        report.failed = true;
+    }
+    return report;
+}
+
+// Виводить зведення завантаження
+void TaskMananger::reportLoad(const LoadReport& report) const {
+    TASK_METRICS_ADD(linesRejected, report.rejected);
+    report.printSummary();
+}
+
+// Повертає ключ рядка сховища для поля сортування
+std::uint32_t TaskMananger::sortKey(std::uint32_t row, SortField field) const {
+    switch (field) {
+        case SortField::Importance: {
+            if (!kindInfo(store.kind(row)).hasPriority) {
+                return 0xFFFFFFFFu;  // Завдання без пріоритету йдуть після важливих
+            }
+            // Більший пріоритет дає менший ключ
+            const int limit = 1 << 30;
+            int priority = std::min(std::max(store.priority(row), -limit), limit);
+            return static_cast<std::uint32_t>(limit - priority);
+        }
+        case SortField::Deadline:
+            return static_cast<std::uint32_t>(store.deadlineDay(row)) ^ 0x80000000u;  // Знаковий номер дня у беззнаковому порядку
+        case SortField::None:
+            break;
+    }
+    return 0;
+}
+
+// Сортує завдання за важливістю
+void TaskMananger::sortByImportance() {
+    sortTasks(SortField::Importance, SortField::Deadline);
+    if (verbose) {
+        std::cout << "Tasks sorted by importance.\n";  // Повідомляємо, що сортування завершено
+    }
+}
+
+// Стабільно сортує завдання за двома ключами
+void TaskMananger::sortTasks(SortField primary, SortField secondary) {
+    TASK_METRICS_SCOPE(Sort);
+    // Ключ обчислюється один раз для кожного завдання, порівняння — лише цілих чисел
+    std::vector<std::pair<std::uint64_t, Task*>> keys;
+    keys.reserve(tasks.size());
+    for (Task* task : tasks) {
+        std::uint64_t key = (static_cast<std::uint64_t>(sortKey(task->row, primary)) << 32) | sortKey(task->row, secondary);
+        keys.emplace_back(key, task);
+    }
+    std::stable_sort(keys.begin(), keys.end(), [](const std::pair<std::uint64_t, Task*>& a, const std::pair<std::uint64_t, Task*>& b) {
+        return a.first < b.first;
+    });
+
+    // Переставляємо вузли списку без виділення пам'яті
+    for (const auto& key : keys) {
+        tasks.splice(tasks.end(), tasks, key.second->position);
+    }
+    rebuildStore();  // Сховище повторює новий порядок списку
+
+    if (journal) {
+        journal->logSort(primary, secondary);
+        commitJournal(false);
+    }
+}
+
+// Скидає групу записів журналу на диск і за потреби ущільнює журнал
+void TaskMananger::commitJournal(bool force) {
+    if (!journal || (!force && !journal->commitDue())) {
+        return;
+    }
+    try {
+        journal->commit();
+    } catch (const std::exception& e) {
+        std::cerr << "Error occurred during journal write: " << e.what() << "\n";  // Записи лишаються в буфері до наступної спроби
+        return;
+    }
+    // Ущільнення переписує O(завдань), тож на одну зміну припадає O(1) амортизовано
+    if (journal->recordCount() > std::max(journalCompactionMin, store.size())) {
+        compactJournal();
+    }
+}
+
+// Відтворює записи журналу, доки вони цілі
+void TaskMananger::replayJournal(std::string_view contents, std::uint64_t snapshotHash, std::size_t& validBytes, std::size_t& validRecords) {
+    validBytes = 0;
+    validRecords = 0;
+    char header[64];
+    int headerLength = std::snprintf(header, sizeof(header), "%s %d %016llx\n", journalMagic, journalVersion,
+                                     static_cast<unsigned long long>(snapshotHash));
+    if (contents.substr(0, static_cast<std::size_t>(headerLength)) != std::string_view(header, static_cast<std::size_t>(headerLength))) {
+        // Журнал іншої версії або від попереднього знімка (збій між записом знімка та нового журналу —
+        // тоді всі його зміни вже є у знімку)
+        if (!contents.empty()) {
+            std::cerr << "Discarded journal that does not match the snapshot\n";
+        }
+        return;
+    }
+    validBytes = static_cast<std::size_t>(headerLength);
+
+    ParsedTask parsed;
+    std::string storage;
+    std::string_view rest = contents.substr(validBytes);
+    while (true) {
+        const char* newline = static_cast<const char*>(std::memchr(rest.data(), '\n', rest.size()));
+        if (!newline) {
+            break;  // Недописаний запис
+        }
+        std::string_view line = rest.substr(0, static_cast<std::size_t>(newline - rest.data()));
+        if (line.size() < 18 || line[16] != ' ') {
+            break;
+        }
+        std::string_view body = line.substr(17);
+        std::uint64_t checksum = 0;
+        auto result = std::from_chars(line.data(), line.data() + 16, checksum, 16);
+        if (result.ec != std::errc() || result.ptr != line.data() + 16 || checksum != hashString(body)) {
+            break;  // Пошкоджений запис: усе після нього теж не можна застосувати
+        }
+
+        std::string_view payload = body.size() > 2 ? body.substr(2) : std::string_view();
+        if (body[0] == 'A') {
+            if (parseTaskLine(payload, true, parsed)) {
+                break;
+            }
+            addTask(createTask(parsed));
+        } else if (body[0] == 'D') {
+            std::string_view fields[2];
+            std::size_t occurrence = 0;
+            if (splitEscapedFields(payload, storage, fields, 2) == 2) {
+                std::from_chars(fields[1].data(), fields[1].data() + fields[1].size(), occurrence);
+            }
+            buildNameIndex();
+            const NameChain* sameName = nameIndex.find(fields[0]);
+            Task* task = sameName ? sameName->oldest : nullptr;
+            for (; task && occurrence > 0; --occurrence) {
+                task = task->nextSameName;
+            }
+            if (task) {
+                removeTask(task);
+            }
+        } else if (body[0] == 'C') {
+            clear();
+        } else if (body[0] == 'S') {
+            int fields[2] = {0, 0};
+            std::string_view text = payload;
+            for (int& field : fields) {
+                std::string_view word = nextWord(text);
+                std::from_chars(word.data(), word.data() + word.size(), field);
+            }
+            sortTasks(static_cast<SortField>(fields[0]), static_cast<SortField>(fields[1]));
+        } else {
+            break;
+        }
+        validBytes += line.size() + 1;
+        ++validRecords;
+        rest.remove_prefix(line.size() + 1);
+    }
+    if (validBytes < contents.size()) {
+        std::cerr << "Discarded " << contents.size() - validBytes << " bytes of incomplete journal records\n";
+    }
+}
+
+// Відкриває журнал змін поверх знімка
+bool TaskMananger::openJournal(const std::string& baseName) {
+    closeJournal();
+    bool hadTasks = !tasks.empty();
+    DuplicatePolicy policy = duplicatePolicy;
+    duplicatePolicy = DuplicatePolicy::Keep;  // Журнал відтворює зміни, що вже відбулися, незалежно від політики
+    try {
+        std::uint64_t snapshotHash = 0;
+        const std::string snapshotName = baseName + snapshotExtension;
+        if (::access(snapshotName.c_str(), F_OK) == 0) {
+            MappedFile snapshot(snapshotName);
+            snapshotHash = hashString(snapshot.contents());
+            LoadReport report;
+            loadSnapshot(snapshot.contents(), report, true);
+        }
+
+        const std::string journalName = baseName + journalExtension;
+        std::size_t validBytes = 0;
+        std::size_t validRecords = 0;
+        if (::access(journalName.c_str(), F_OK) == 0) {
+            MappedFile file(journalName);
+            replayJournal(file.contents(), snapshotHash, validBytes, validRecords);
+        }
+        duplicatePolicy = policy;
+
+        journal.reset(new TaskJournal(journalName, snapshotHash, validBytes, validRecords));
+        journalBase = baseName;
+        if (hadTasks && !compactJournal()) {
+            return false;  // Завдання, додані до відкриття журналу, мають потрапити у знімок
+        }
+        if (verbose) {
+            std::cout << "Journal opened: " << size() << " tasks, " << validRecords << " records replayed\n";
+        }
+        return true;
+    } catch (const std::exception& e) {
+        duplicatePolicy = policy;
+        std::cerr << "Error occurred during journal opening: " << e.what() << "\n";
+        return false;
+    }
+}
+
+// Записує всі завдання у новий знімок і починає порожній журнал
+bool TaskMananger::compactJournal() {
+    if (!journal) {
+        return true;
+    }
+    try {
+        journal->commit();
+        const std::string snapshotName = journalBase + snapshotExtension;
+        const std::string journalName = journalBase + journalExtension;
+        const std::string snapshotTemp = snapshotName + ".tmp";
+        const std::string journalTemp = journalName + ".tmp";
+
+        std::ofstream file(snapshotTemp, std::ios::out | std::ios::binary);
+        if (!file.is_open()) {
+            throw std::runtime_error("Error: can't open snapshot for writing");
+        }
+        saveSnapshot(file);
+        file.close();
+        if (!file || !syncPath(snapshotTemp)) {
+            throw std::runtime_error("Error: can't write snapshot");
+        }
+        std::uint64_t snapshotHash = hashString(MappedFile(snapshotTemp).contents());
+        std::unique_ptr<TaskJournal> fresh(new TaskJournal(journalTemp, snapshotHash, 0, 0));
+
+        // Спочатку знімок, потім журнал: після збою між перейменуваннями старий журнал не збігається
+        // з новим знімком за хешем і відкидається, а всі його зміни вже є у знімку
+        if (std::rename(snapshotTemp.c_str(), snapshotName.c_str()) != 0) {
+            throw std::runtime_error("Error: can't replace snapshot");  // Старі знімок і журнал лишаються чинними
+        }
+        if (std::rename(journalTemp.c_str(), journalName.c_str()) != 0) {
+            // Старий журнал уже не відповідає знімку, а новий лежить не на своєму місці: дописувати нікуди,
+            // тож журнал закривається, щоб зміни не зникали непомітно (усе, що було досі, є у знімку)
+            fresh.reset();
+            std::remove(journalTemp.c_str());
+            journal.reset();
+            journalBase.clear();
+            throw std::runtime_error("Error: can't replace journal, journaling stopped");
+        }
+        std::size_t slash = journalBase.rfind('/');
+        syncPath(slash == std::string::npos ? "." : journalBase.substr(0, slash + 1));  // Перейменування теж мають потрапити на диск
+        journal = std::move(fresh);
+        return true;
+    } catch (const std::exception& e) {
+        std::cerr << "Error occurred during journal compaction: " << e.what() << "\n";
+        return false;
+    }
+}
+
+// Скидає журнал на диск і закриває його
+void TaskMananger::closeJournal() {
+    journal.reset();  // Деструктор журналу скидає буфер на диск
+    journalBase.clear();
+}
+
+// Виводить лічильники операцій
+void TaskMananger::writeMetrics(std::ostream& os, bool json) const {
+#if TASK_METRICS
+    metrics.write(os, json);
+#else
+    os << (json ? "{\"enabled\":false}\n" : "Metrics are compiled out (TASK_METRICS=0)\n");
+#endif
+}
+
+// Копія даних завдання, що повертається з ConcurrentTaskMananger (не залежить від блокувань)
+struct TaskRecord {
+    TaskKind kind = TaskKind::Normal;
+    std::string name;
+    std::string description;
+    std::int32_t deadlineDay = 0;
+    int priority = 0;
+};
+
+// Копіює дані завдання у TaskRecord
+TaskRecord makeTaskRecord(Task* task) {
+    TaskRecord record;
+    record.kind = task->kind();
+    record.priority = task->priority();
+    record.name = task->getName();
+    record.description = task->getDescription();
+    record.deadlineDay = task->getDeadlineDay();
+    return record;
+}
+
+// Потокобезпечний менеджер завдань: завдання розподілені між сегментами за хешем назви,
+// кожен сегмент має власний TaskMananger і блокування читач/письменник.
+// Запити, що охоплюють кілька сегментів, бачать кожен сегмент узгодженим, але не всі одночасно.
+class ConcurrentTaskMananger {
+    // Сегмент вирівняний по лінії кешу, щоб блокування сусідніх сегментів не заважали одне одному
+    struct alignas(64) Shard {
+        mutable std::shared_mutex mutex;
+        TaskMananger manager;
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards;
+
+    // Сегмент для назви (старші біти хешу, бо молодші використовує хеш-таблиця всередині сегмента)
+    Shard& shardFor(std::string_view name) const {
+        return *shards[(hashString(name) >> 32) % shards.size()];
+    }
+
+public:
+    explicit ConcurrentTaskMananger(std::size_t shardCount = 16);
+
+    // Додає завдання, створене через new, і бере його у володіння
+    bool addTask(Task* task);
+    
+    // Додає завдання з розібраного рядка
+    bool addTask(const ParsedTask& parsed);
+    
+    // Видаляє завдання за назвою
+    bool deleteTask(std::string_view taskName);
+    
+    // Шукає завдання за назвою та копіює його дані в record
+    bool findTask(std::string_view taskName, TaskRecord& record) const;
+    
+    // Повертає завдання з дедлайном у межах [from, to] у порядку дедлайнів
+    std::vector<TaskRecord> tasksDueBetween(const std::tm& from, const std::tm& to) const;
+    
+    // Рахує завдання, що задовольняють умову
+    std::size_t countTasks(const TaskFilter& filter) const;
+    
+    // Завантажує завдання з файлу, блокуючи кожен сегмент один раз
+    LoadReport loadFromFile(const std::string& fileName);
+    
+    // Повертає кількість завдань
+    std::size_t size() const;
+};
+
+ConcurrentTaskMananger::ConcurrentTaskMananger(std::size_t shardCount) {
+    for (std::size_t i = 0; i < std::max<std::size_t>(shardCount, 1); ++i) {
+        shards.emplace_back(new Shard());
+        shards.back()->manager.setVerbose(false);
+    }
+}
+
+bool ConcurrentTaskMananger::addTask(Task* task) {
+    Shard& shard = shardFor(task->getName());
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    return shard.manager.addTask(task);
+}
+
+bool ConcurrentTaskMananger::addTask(const ParsedTask& parsed) {
+    Shard& shard = shardFor(parsed.name);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    return shard.manager.addTask(shard.manager.createTask(parsed));  // Завдання створюється в арені свого сегмента
+}
+
+bool ConcurrentTaskMananger::deleteTask(std::string_view taskName) {
+    Shard& shard = shardFor(taskName);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    return shard.manager.deleteTask(taskName);
+}
+
+bool ConcurrentTaskMananger::findTask(std::string_view taskName, TaskRecord& record) const {
+    Shard& shard = shardFor(taskName);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    Task* task = shard.manager.findTask(taskName);
+    if (!task) {
+        return false;
+    }
+    record = makeTaskRecord(task);
+    return true;
+}
+
+std::vector<TaskRecord> ConcurrentTaskMananger::tasksDueBetween(const std::tm& from, const std::tm& to) const {
+    std::vector<TaskRecord> result;
+    for (const auto& shard : shards) {
+        std::shared_lock<std::shared_mutex> lock(shard->mutex);
+        for (Task* task : shard->manager.tasksDueBetween(from, to)) {
+            result.push_back(makeTaskRecord(task));
+        }
+    }
+    // Кожен сегмент уже впорядкований; стабільне сортування зберігає порядок усередині дня
+    std::stable_sort(result.begin(), result.end(), [](const TaskRecord& a, const TaskRecord& b) {
+        return a.deadlineDay < b.deadlineDay;
+    });
+    return result;
+}
+
+std::size_t ConcurrentTaskMananger::countTasks(const TaskFilter& filter) const {
+    std::size_t count = 0;
+    for (const auto& shard : shards) {
+        std::shared_lock<std::shared_mutex> lock(shard->mutex);
+        count += shard->manager.countTasks(filter);
+    }
+    return count;
+}
+
+LoadReport ConcurrentTaskMananger::loadFromFile(const std::string& fileName) {
+    LoadReport report;
+    try {
+        MappedFile file(fileName);
+
+        // Спочатку розподіляємо рядки між сегментами без блокувань
+        std::vector<std::vector<ParsedTask>> pending(shards.size());
+        std::deque<std::string> unescaped;  // Поля рядків з екрануванням (решта вказує у файл)
+        parseTaskText(file.contents(), 1, hasEscapedHeader(file.contents()), report, [this, &pending, &unescaped](const ParsedTask& parsed) {
+            ParsedTask task;
+            task.kind = parsed.kind;
+            task.deadlineDay = parsed.deadlineDay;
+            task.priority = parsed.priority;
+            task.name = parsed.name;
+            task.description = parsed.description;
+            if (!parsed.unescaped.empty()) {
+                unescaped.emplace_back(parsed.name);
+                task.name = unescaped.back();
+                unescaped.emplace_back(parsed.description);
+                task.description = unescaped.back();
+            }
+            pending[(hashString(task.name) >> 32) % shards.size()].push_back(std::move(task));
+        });
+
+        // Потім блокуємо кожен сегмент один раз і додаємо всі його завдання однією вставкою
+        std::vector<Task*> batch;
+        for (std::size_t i = 0; i < shards.size(); ++i) {
+            std::unique_lock<std::shared_mutex> lock(shards[i]->mutex);
+            TaskMananger& manager = shards[i]->manager;
+            batch.clear();
+            batch.reserve(pending[i].size());
+            for (const ParsedTask& parsed : pending[i]) {
+                batch.push_back(manager.createTask(parsed));
+            }
+            std::size_t added = manager.addTasks(batch);
+            report.loaded += added;
+            report.duplicates += batch.size() - added;
+        }
+        report.printSummary();
+    } catch (const std::exception& e) {
+        std::cerr << "Error occurred during file loading: " << e.what() << "\n";  // Якщо сталася помилка
+        report.failed = true;
+    }
+    return report;
+}
+
+std::size_t ConcurrentTaskMananger::size() const {
+    std::size_t count = 0;
+    for (const auto& shard : shards) {
+        std::shared_lock<std::shared_mutex> lock(shard->mutex);
+        count += shard->manager.size();
+    }
+    return count;
+}
+
+// Клас для управління меню
+class Menu {
+    TaskMananger taskManager;  // Об'єкт менеджера завдань
+
+public:
+    Menu() {}
+
+    void displayMenu();  // Відображає меню
+    void handleInput();  // Обробляє введення користувача
+
+    void addTask();      // Додає звичайне завдання
+    void deleteTask();   // Видаляє завдання
+    void printTasks();   // Виводить усі завдання
+    void filterTasks();  // Фільтрує завдання за дедлайном
+    void saveToFile();   // Зберігає завдання у файл
+    void loadFromFile(); // Завантажує завдання з файлу
+    void searchTasks();  // Шукає завдання за словами
+    void showMetrics();  // Виводить лічильники операцій
+    void deleteOverdue(); // Видаляє всі прострочені завдання
+
+    // Виконує одну команду пакетного режиму; повертає опис помилки або nullptr
+    const char* runCommand(std::string_view command);
+    
+    // Виконує команди з потоку (по одній на рядок) без запитів; повертає кількість помилок
+    std::size_t runBatch(std::istream& input);
+    
+    // Вмикає або вимикає повідомлення про успішні операції
+    void setVerbose(bool enabled) { taskManager.setVerbose(enabled); }
+    
+    // Відкриває журнал змін (baseName.journal поверх знімка baseName.tsnap); повертає false, якщо журнал не відкрився
+    bool openJournal(const std::string& baseName) { return taskManager.openJournal(baseName); }
+    
+    // Виводить лічильники операцій у потік (таблицею або JSON)
+    void writeMetrics(std::ostream& os, bool json) const { taskManager.writeMetrics(os, json); }
+};
+
+// Відображає меню користувачеві
+void Menu::displayMenu() {
+    std::cout << "\nTask Manager Menu:\n";
+    std::cout << "1. Add Normal Task\n";       // Додати звичайне завдання
+    std::cout << "2. Add Important Task\n";    // Додати важливе завдання
+    std::cout << "3. Delete Task\n";           // Видалити завдання
+    std::cout << "4. View All Tasks\n";        // Переглянути всі завдання
+    std::cout << "5. Filter Tasks by Deadline\n";  // Фільтрувати завдання за дедлайном
+    std::cout << "6. Sort Tasks by Importance\n";  // Сортувати завдання за важливістю
+    std::cout << "7. Save Tasks to File\n";    // Зберегти завдання у файл
+    std::cout << "8. Load Tasks from File\n";  // Завантажити завдання з файлу
+    std::cout << "9. Exit\n";                  // Вийти з програми
+    std::cout << "10. Search Tasks\n";         // Шукати завдання за словами
+    std::cout << "11. Show Metrics\n";         // Показати лічильники операцій
+    std::cout << "12. Delete Overdue Tasks\n"; // Видалити прострочені завдання
+    std::cout << "Enter your choice: ";        // Запитати вибір користувача
+}
+
+// Обробляє введення користувача та викликає відповідні функції
+void Menu::handleInput() {
+    int choice = 0;
+
+    while (true) {
+        displayMenu();  // Показати меню
+        std::cin >> choice;  // Отримати вибір користувача
+
+        if (std::cin.fail()) {  // Якщо введено некоректні дані
+            std::cin.clear();  // Очищуємо стан помилки
+            std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');  // Пропускаємо некоректний ввід
+            std::cout << "Invalid input. Please enter a number.\n";
+            continue;
+        }
+
+        // Виконати дію на основі вибору користувача
+        switch (choice) {
+            case 1:
+                addTask();  // Додати звичайне завдання
+                break;
+            case 2: {
+                TaskString name, description;
+                std::string deadlineStr;
+                int priority;
+                std::tm deadline = {};
+
+                std::cin.ignore();  // Ігноруємо символ нового рядка
+                std::cout << "Enter task name: ";  // Запитуємо назву завдання
+                std::getline(std::cin, name);
+                std::cout << "Enter task description: ";  // Запитуємо опис завдання
+                std::getline(std::cin, description);
+                std::cout << "Enter task deadline (YYYY-MM-DD): ";  // Запитуємо дедлайн
+                std::getline(std::cin, deadlineStr);
+
+                // Перевіряємо коректність формату дати
+                if (strptime(deadlineStr.c_str(), "%Y-%m-%d", &deadline) == nullptr) {
+                    std::cout << "Invalid date format. Please use YYYY-MM-DD.\n";
+                    break;
+                }
+
+                // Запитуємо пріоритет завдання, доки не буде введено коректне значення
+                do {
+                    std::cout << "Enter priority (1-10): ";
+                    std::cin >> priority;
+
+                    if (std::cin.fail()) {
+                        std::cin.clear();  // Очищуємо стан помилки
+                        std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');  // Пропускаємо некоректний ввід
+                        std::cout << "Invalid input. Please enter a number.\n";
+                    } else if (priority < 1 || priority > 10) {
+                        std::cout << "Priority must be between 1 and 10.\n";  // Перевірка діапазону
+                    }
+                } while (std::cin.fail() || priority < 1 || priority > 10);
+
+                // Додаємо важливе завдання
+                taskManager.addTask(new ImportantTask(std::move(name), std::move(description), deadline, priority));
+                std::cout << "Important task added successfully.\n";
+                break;
+            }
+            case 3:
+                deleteTask();  // Видалити завдання
+                break;
+            case 4:
+                printTasks();  // Вивести усі завдання
+                break;
+            case 5:
+                filterTasks();  // Фільтрувати завдання за дедлайном
+                break;
+            case 6:
+                taskManager.sortByImportance();  // Сортувати завдання за важливістю
+                break;
+            case 7:
+                saveToFile();  // Зберегти завдання у файл
+                break;
+            case 8:
+                loadFromFile();  // Завантажити завдання з файлу
+                break;
+            case 9:
+                std::cout << "Exiting...\n";  // Вихід з програми
+                return;
+            case 10:
+                searchTasks();  // Шукати завдання за словами
+                break;
+            case 11:
+                showMetrics();  // Показати лічильники операцій
+                break;
+            case 12:
+                deleteOverdue();  // Видалити прострочені завдання
+                break;
+            default:
+                std::cout << "Invalid choice. Please select again.\n";  // Невірний вибір
+        }
+        taskManager.syncJournal();  // Зміни, зроблені через меню, одразу потрапляють на диск
+
+    }
+}
+
+// Додає звичайне завдання
+void Menu::addTask() {
+    TaskString name, description;
+    std::string deadlineStr;
+    std::tm deadline = {};
+
+    std::cin.ignore();  // Ігноруємо символ нового рядка
+    std::cout << "Enter task name: ";  // Запитуємо назву завдання
+    std::getline(std::cin, name);
+    std::cout << "Enter task description: ";  // Запитуємо опис завдання
+    std::getline(std::cin, description);
+    std::cout << "Enter task deadline (YYYY-MM-DD): ";  // Запитуємо дедлайн
+    std::getline(std::cin, deadlineStr);
+
+    // Перевіряємо коректність формату дати
+    if (strptime(deadlineStr.c_str(), "%Y-%m-%d", &deadline) == nullptr) {
+        std::cout << "Invalid date format. Please use YYYY-MM-DD.\n";
+        return;
+    }
+
+    // Додаємо звичайне завдання
+    taskManager.addTask(new NormalTask(std::move(name), std::move(description), deadline));
+    std::cout << "Normal task added successfully.\n";
+}
+
+// Видаляє завдання за назвою
+void Menu::deleteTask() {
+    std::string name;
+
+    std::cin.ignore();  // Ігноруємо символ нового рядка
+    std::cout << "Enter task name to delete: ";  // Запитуємо назву завдання для видалення
+    std::getline(std::cin, name);
+
+    // Якщо завдання знайдено і видалено
+    if (taskManager.deleteTask(name)) {
+        std::cout << "Task deleted successfully.\n";
+    } else {
+        std::cout << "Task not found.\n";  // Якщо завдання не знайдено
+    }
+}
+
+// Виводить усі завдання
+void Menu::printTasks() {
+    taskManager.printTasks();  // Викликаємо функцію виведення завдань менеджера завдань
+}
+
+// Фільтрує завдання за дедлайном
+void Menu::filterTasks() {
+    std::string deadlineStr;
+    std::tm deadline = {};
+
+    std::cin.ignore();  // Ігноруємо символ нового рядка
+    std::cout << "Enter the deadline (YYYY-MM-DD) to filter tasks: ";  // Запитуємо дедлайн для фільтрації
+    std::getline(std::cin, deadlineStr);
+
+    // Перевіряємо коректність формату дати
+    if (strptime(deadlineStr.c_str(), "%Y-%m-%d", &deadline) == nullptr) {
+        std::cout << "Invalid date format. Please use YYYY-MM-DD.\n";
+        return;
+    }
+
+    // Фільтруємо завдання за дедлайном
+    taskManager.filterTasksByDeadline(deadline);
+}
+
+// Зберігає завдання у файл
+void Menu::saveToFile() {
+    std::string fileName;
+
+    std::cin.ignore();  // Ігноруємо символ нового рядка
+    std::cout << "Enter file name to save tasks: ";  // Запитуємо назву файлу для збереження
+    std::getline(std::cin, fileName);
+
+    // Зберігаємо завдання у файл
+    taskManager.saveToFile(fileName);
+}
+
+// Завантажує завдання з файлу
+void Menu::loadFromFile() {
+    std::string fileName;
+
+    std::cin.ignore(); // Ігноруємо символ нового рядка
+    std::cout << "Enter file name to load tasks: "; // Запитуємо назву файлу для загрузки
+    std::getline(std::cin, fileName);
+
+     // Загружаєм завдання з файлу
+    taskManager.loadFromFile(fileName);
+}
+
+// Шукає завдання за словами з назви та опису, за потреби — в межах дедлайнів
+void Menu::searchTasks() {
+    std::string query, fromStr, toStr;
+    TaskFilter filter;
+
+    std::cin.ignore();  // Ігноруємо символ нового рядка
+    std::cout << "Enter search query (words, prefix*, AND, OR): ";  // Запитуємо запит
+    std::getline(std::cin, query);
+    std::cout << "Enter earliest deadline (YYYY-MM-DD) or leave empty: ";  // Запитуємо початок діапазону
+    std::getline(std::cin, fromStr);
+    std::cout << "Enter latest deadline (YYYY-MM-DD) or leave empty: ";  // Запитуємо кінець діапазону
+    std::getline(std::cin, toStr);
+
+    // Перевіряємо коректність формату дат
+    if ((!fromStr.empty() && !parseDate(fromStr, filter.fromDay)) || (!toStr.empty() && !parseDate(toStr, filter.toDay))) {
+        std::cout << "Invalid date format. Please use YYYY-MM-DD.\n";
+        return;
+    }
+
+    taskManager.printTasks(taskManager.searchTasks(query, filter));
+}
+
+// Виводить лічильники операцій
+void Menu::showMetrics() {
+    std::string format;
+
+    std::cin.ignore();  // Ігноруємо символ нового рядка
+    std::cout << "Enter format (text or json, empty for text): ";  // Запитуємо формат
+    std::getline(std::cin, format);
+
+    if (!format.empty() && format != "text" && format != "json") {
+        std::cout << "Invalid format. Please enter text or json.\n";
+        return;
+    }
+    taskManager.writeMetrics(std::cout, format == "json");
+}
+
+// Видаляє всі завдання з дедлайном раніше сьогоднішнього дня
+void Menu::deleteOverdue() {
+    TaskFilter filter;
+    filter.toDay = currentDay() - 1;
+    std::cout << "Deleted " << taskManager.deleteWhere(filter) << " overdue tasks.\n";
+}
+
+// Розбирає умови запиту до файлу на початку команди (format: — лише якщо format не nullptr);
+// command лишається з рештою рядка. Повертає опис помилки або nullptr
+const char* parseQueryOptions(std::string_view& command, TaskQuery& query, ReportFormat* format, bool& hasCondition) {
+    hasCondition = false;
+    while (true) {
+        command.remove_prefix(std::min(command.find_first_not_of(' '), command.size()));
+        std::string_view rest = command;
+        std::string_view option = nextWord(rest);
+        std::size_t colon = option.find(':');
+        if (colon == std::string_view::npos || rest.find_first_not_of(' ') == std::string_view::npos) {
+            return nullptr;  // Останнє слово — назва файлу
+        }
+        std::string_view key = option.substr(0, colon);
+        std::string_view value = option.substr(colon + 1);
+        if (key == "from" || key == "to") {
+            if (!parseDate(value, key == "from" ? query.filter.fromDay : query.filter.toDay)) {
+                return "invalid date, expected YYYY-MM-DD";
+            }
+        } else if (key == "min-priority" || key == "max-priority") {
+            int& bound = key == "min-priority" ? query.filter.minPriority : query.filter.maxPriority;
+            if (!parseNumber(value, bound)) {
+                return "invalid priority";
+            }
+        } else if (key == "name") {
+            query.nameContains = std::string(value);
+        } else if (key == "format" && format) {
+            if (!parseReportFormat(value, *format)) {
+                return "unknown format, expected table, csv, tsv or jsonl";
+            }
+            command = rest;
+            continue;  // Формат не є умовою
+        } else {
+            return nullptr;  // Не умова — далі назва файлу (вона може містити ':')
+        }
+        hasCondition = true;
+        command = rest;
+    }
+}
+
+// Виконує одну команду пакетного режиму:
+//   add Type|name|description|YYYY-MM-DD[|priority]   delete <name>
+//   print [format]   filter YYYY-MM-DD [format]   top <count> [format]   export <format> <file>
+//   sort [importance|deadline [importance|deadline]]   save <file>   load <file>
+//   threads <count>   duplicates keep|skip|replace   clear
+//   search [from:YYYY-MM-DD] [to:YYYY-MM-DD] [format:<format>] <query>
+//   journal <base>   compact   metrics [text|json]
+//   purge [overdue] [before:YYYY-MM-DD] [priority-below:<n>]
+//   query [<condition> ...] [format:<format>] <file>   load [<condition> ...] <file>
+// Умови запиту до файлу: from:YYYY-MM-DD to:YYYY-MM-DD min-priority:<n> max-priority:<n> name:<text>
+// Умови за пріоритетом (priority-below, min-priority, max-priority) відбирають лише типи з пріоритетом
+// Формати звіту: table, csv, tsv, jsonl
+const char* Menu::runCommand(std::string_view command) {
+    std::string_view name = nextWord(command);
+    ReportFormat format = ReportFormat::Table;
+
+    if (name == "add") {
+        ParsedTask parsed;
+        if (const char* error = parseTaskLine(command, true, parsed)) {  // У командах поля можна екранувати
+            return error;
+        }
+        if (!taskManager.addTask(taskManager.createTask(parsed))) {
+            return "task with this name already exists";
+        }
+    } else if (name == "delete") {
+        if (!taskManager.deleteTask(command)) {
+            return "task not found";
+        }
+    } else if (name == "print") {
+        std::string_view formatName = nextWord(command);
+        if (!formatName.empty() && !parseReportFormat(formatName, format)) {
+            return "unknown format, expected table, csv, tsv or jsonl";
+        }
+        taskManager.printTasks(format);
+    } else if (name == "top") {
+        std::string_view count = nextWord(command);
+        std::size_t k = 0;
+        std::string_view formatName = nextWord(command);
+        if (!parseNumber(count, k) || (!formatName.empty() && !parseReportFormat(formatName, format))) {
+            return "expected top <count> [format]";
+        }
+        taskManager.printTasks(taskManager.topK(k), format);
+    } else if (name == "filter") {
+        std::int32_t day = 0;
+        if (!parseDate(nextWord(command), day)) {
+            return "invalid date, expected YYYY-MM-DD";
+        }
+        std::string_view formatName = nextWord(command);
+        if (!formatName.empty() && !parseReportFormat(formatName, format)) {
+            return "unknown format, expected table, csv, tsv or jsonl";
+        }
+        taskManager.filterTasksByDeadline(tmFromDay(day), format);
+    } else if (name == "export") {
+        if (!parseReportFormat(nextWord(command), format) || command.empty()) {
+            return "expected export <table|csv|tsv|jsonl> <file>";
+        }
+        if (!taskManager.exportTasks(std::string(command), format)) {
+            return "export failed";
+        }
+    } else if (name == "sort") {
+        SortField fields[2] = {SortField::Importance, SortField::Deadline};
+        for (SortField& field : fields) {
+            std::string_view fieldName = nextWord(command);
+            if (fieldName == "importance") {
+                field = SortField::Importance;
+            } else if (fieldName == "deadline") {
+                field = SortField::Deadline;
+            } else if (!fieldName.empty()) {
+                return "unknown sort field, expected importance or deadline";
+            } else if (&field == &fields[1]) {
+                field = fields[0] == SortField::Importance ? SortField::Deadline : SortField::None;
+            }
+        }
+        taskManager.sortTasks(fields[0], fields[1]);
+    } else if (name == "search") {
+        TaskFilter filter;
+        while (true) {
+            std::string_view rest = command;
+            std::string_view option = nextWord(rest);
+            if (option.substr(0, 5) == "from:") {
+                if (!parseDate(option.substr(5), filter.fromDay)) {
+                    return "invalid date, expected YYYY-MM-DD";
+                }
+            } else if (option.substr(0, 3) == "to:") {
+                if (!parseDate(option.substr(3), filter.toDay)) {
+                    return "invalid date, expected YYYY-MM-DD";
+                }
+            } else if (option.substr(0, 7) == "format:") {
+                if (!parseReportFormat(option.substr(7), format)) {
+                    return "unknown format, expected table, csv, tsv or jsonl";
+                }
+            } else {
+                break;  // Решта рядка — запит
+            }
+            command = rest;
+        }
+        if (command.find_first_not_of(' ') == std::string_view::npos) {
+            return "expected search [from:YYYY-MM-DD] [to:YYYY-MM-DD] [format:<format>] <query>";
+        }
+        taskManager.printTasks(taskManager.searchTasks(command, filter), format);
+    } else if (name == "purge") {
+        TaskFilter filter;
+        bool hasCondition = false;
+        for (std::string_view option = nextWord(command); !option.empty(); option = nextWord(command)) {
+            std::int32_t day = 0;
+            int priority = 0;
+            if (option == "overdue") {
+                filter.toDay = std::min(filter.toDay, currentDay() - 1);
+            } else if (option.substr(0, 7) == "before:" && parseDate(option.substr(7), day)) {
+                filter.toDay = std::min(filter.toDay, day - 1);
+            } else if (option.substr(0, 15) == "priority-below:" && parseNumber(option.substr(15), priority)) {
+                filter.maxPriority = std::min(filter.maxPriority, priority - 1);
+            } else {
+                return "expected purge [overdue] [before:YYYY-MM-DD] [priority-below:<n>]";
+            }
+            hasCondition = true;
+        }
+        if (!hasCondition) {
+            return "expected purge [overdue] [before:YYYY-MM-DD] [priority-below:<n>]";  // Без умови видалилося б усе
+        }
+        taskManager.deleteWhere(filter);
+    } else if (name == "journal") {
+        if (command.empty()) {
+            return "expected journal <base>";
+        }
+        if (!taskManager.openJournal(std::string(command))) {
+            return "can't open journal";
+        }
+    } else if (name == "compact") {
+        if (!taskManager.compactJournal()) {
+            return "journal compaction failed";
+        }
+    } else if (name == "metrics") {
+        std::string_view formatName = nextWord(command);
+        if (!formatName.empty() && formatName != "text" && formatName != "json") {
+            return "expected metrics [text|json]";
+        }
+        taskManager.writeMetrics(std::cout, formatName == "json");
+    } else if (name == "clear") {
+        taskManager.clear();
+    } else if (name == "save") {
+        if (command.empty()) {
+            return "expected save <file>";
+        }
+        if (!taskManager.saveToFile(std::string(command))) {
+            return "can't save file";
+        }
+    } else if (name == "load") {
+        TaskQuery query;
+        bool hasCondition = false;
+        if (const char* error = parseQueryOptions(command, query, nullptr, hasCondition)) {
+            return error;
+        }
+        if (command.empty()) {
+            return "expected load [<condition> ...] <file>";
+        }
+        // З умовами файл читається потоком, завантажуються лише збіги
+        LoadReport report = hasCondition ? taskManager.loadMatching(std::string(command), query)
+                                         : taskManager.loadFromFile(std::string(command));
+        if (report.failed) {
+            return "can't load file";
+        }
+    } else if (name == "query") {
+        TaskQuery query;
+        bool hasCondition = false;
+        if (const char* error = parseQueryOptions(command, query, &format, hasCondition)) {
+            return error;
+        }
+        if (command.empty()) {
+            return "expected query [<condition> ...] [format:<format>] <file>";
+        }
+        try {
+            ReportWriter writer(STDOUT_FILENO, format);
+            LoadReport report = writeMatchingTasks(std::string(command), query, writer);
+            writer.flush();
+            report.printSummary();
+        } catch (const std::exception& e) {
+            std::cerr << "Error occurred during file query: " << e.what() << "\n";
+            return "can't query file";
+        }
+    } else if (name == "threads") {
+        std::string_view count = nextWord(command);
+        unsigned threads = 0;
+        if (!parseNumber(count, threads)) {
+            return "expected threads <count>";
+        }
+        taskManager.setLoadThreads(threads);
+    } else if (name == "duplicates") {
+        std::string_view policy = nextWord(command);
+        if (policy == "keep") {
+            taskManager.setDuplicatePolicy(DuplicatePolicy::Keep);
+        } else if (policy == "skip") {
+            taskManager.setDuplicatePolicy(DuplicatePolicy::Skip);
+        } else if (policy == "replace") {
+            taskManager.setDuplicatePolicy(DuplicatePolicy::Replace);
+        } else {
+            return "expected duplicates keep|skip|replace";
+        }
+    } else {
+        return "unknown command";
+    }
+    return nullptr;
+}
+
+// Виконує команди з потоку без запитів
+std::size_t Menu::runBatch(std::istream& input) {
+    std::size_t errors = 0;
+    std::size_t lineNumber = 0;
+    std::string line;
+    while (std::getline(input, line)) {
+        ++lineNumber;
+        std::string_view command = line;
+        if (!command.empty() && command.back() == '\r') {
+            command.remove_suffix(1);
+        }
+        std::size_t start = command.find_first_not_of(' ');
+        if (start == std::string_view::npos || command[start] == '#') {
+            continue;  // Порожні рядки та коментарі
+        }
+        if (const char* error = runCommand(command.substr(start))) {
+            std::cerr << "line " << lineNumber << ": " << error << "\n";
+            ++errors;
+        }
+    }
+    taskManager.syncJournal();
+    return errors;
+}
+
+#if TASK_METRICS && TASK_COUNT_ALLOCATIONS
+// Заміни operator new/delete рахують виділення в allocationCount.
+// Вони не вбудовуються, щоб компілятор не порівнював malloc/free з new/delete у місцях виклику
+
+[[gnu::noinline]] void* operator new(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+
+[[gnu::noinline]] void* operator new(std::size_t size, std::align_val_t alignment) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    std::size_t align = static_cast<std::size_t>(alignment);
+    if (void* memory = std::aligned_alloc(align, (size + align - 1) / align * align)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void operator delete(void* memory) noexcept { std::free(memory); }
+[[gnu::noinline]] void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+[[gnu::noinline]] void operator delete(void* memory, std::align_val_t) noexcept { std::free(memory); }
+[[gnu::noinline]] void operator delete(void* memory, std::size_t, std::align_val_t) noexcept { std::free(memory); }
+#endif
+
+// Вимірює час виконання функції в мілісекундах
+template <typename Function>
+double measureMs(Function&& function) {
+    auto start = std::chrono::steady_clock::now();
+    function();
+    auto finish = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(finish - start).count();
+}
+
+// Навантаження з потоками читачів і письменників для ConcurrentTaskMananger та TaskMananger.
+// Перевіряє, що після паралельних додавань і видалень кожне завдання знаходиться за назвою.
+// Повертає false, якщо якесь щойно додане завдання не знайшлося або менеджери закінчили з різною кількістю завдань
+bool runConcurrencyBenchmark(std::size_t count) {
+    const unsigned maxThreads = std::max(2u, std::thread::hardware_concurrency());
+    const std::size_t operationsPerThread = std::max<std::size_t>(count / maxThreads, 1000);
+    const std::tm from = tmFromDay(daysFromCivil(2024, 6, 1));
+    const std::tm to = tmFromDay(daysFromCivil(2024, 6, 7));
+    bool passed = true;
+
+    // Кожна 10-та операція — запис (додавання, кожне друге додане потім видаляється), решта — читання
+    auto runWorkload = [&](unsigned threads, auto&& add, auto&& remove, auto&& find, auto&& rangeQuery) {
+        std::vector<std::thread> workers;
+        std::atomic<std::size_t> failures{0};
+        double ms = measureMs([&]() {
+            for (unsigned t = 0; t < threads; ++t) {
+                workers.emplace_back([&, t]() {
+                    ParsedTask parsed;
+                    parsed.description = "concurrent benchmark task";
+                    std::string name;
+                    std::size_t added = 0;
+                    for (std::size_t i = 0; i < operationsPerThread; ++i) {
+                        if (i % 10 == 0) {
+                            name = "t" + std::to_string(t) + "-" + std::to_string(added++);
+                            parsed.name = name;
+                            parsed.deadlineDay = daysFromCivil(2024, 1, 1) + static_cast<std::int32_t>(i % 366);
+                            add(parsed);
+                            if (added % 2 == 0 && !remove(name)) {
+                                failures.fetch_add(1);  // Щойно додане завдання мало знайтися
+                            }
+                        } else if (i % 100 == 1) {
+                            rangeQuery(from, to);
+                        } else {
+                            name = "t" + std::to_string(t) + "-" + std::to_string(i % (added + 1));
+                            find(name);
+                        }
+                    }
+                });
+            }
+            for (std::thread& worker : workers) {
+                worker.join();
+            }
+        });
+        if (failures.load() > 0) {
+            std::cout << "  consistency check FAILED: " << failures.load() << " missing tasks\n";
+            passed = false;
+        }
+        return static_cast<double>(operationsPerThread * threads) / ms * 1000.0;
+    };
+
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        // Звичайний TaskMananger під одним спільним блокуванням
+        TaskMananger single;
+        single.setVerbose(false);
+        std::mutex singleMutex;
+        double singleOps = runWorkload(threads,
+            [&](const ParsedTask& parsed) { std::lock_guard<std::mutex> lock(singleMutex); single.addTask(single.createTask(parsed)); },
+            [&](const std::string& name) { std::lock_guard<std::mutex> lock(singleMutex); return single.deleteTask(name); },
+            [&](const std::string& name) {
+                std::lock_guard<std::mutex> lock(singleMutex);
+                Task* task = single.findTask(name);
+                return task ? (makeTaskRecord(task), true) : false;  // Дані копіюються під блокуванням, як і в сегментованому варіанті
+            },
+            [&](const std::tm& a, const std::tm& b) {
+                std::lock_guard<std::mutex> lock(singleMutex);
+                std::vector<TaskRecord> records;
+                for (Task* task : single.tasksDueBetween(a, b)) {
+                    records.push_back(makeTaskRecord(task));
+                }
+                return records.size();
+            });
+
+        // Сегментований ConcurrentTaskMananger
+        ConcurrentTaskMananger sharded;
+        double shardedOps = runWorkload(threads,
+            [&](const ParsedTask& parsed) { sharded.addTask(parsed); },
+            [&](const std::string& name) { return sharded.deleteTask(name); },
+            [&](const std::string& name) { TaskRecord record; return sharded.findTask(name, record); },
+            [&](const std::tm& a, const std::tm& b) { return sharded.tasksDueBetween(a, b).size(); });
+
+        bool consistent = single.size() == sharded.size();
+        passed = passed && consistent;
+        std::cout << "mixed workload, " << threads << " threads: single lock " << static_cast<std::size_t>(singleOps)
+                  << " ops/s, sharded " << static_cast<std::size_t>(shardedOps) << " ops/s"
+                  << (consistent ? "" : " (task counts differ!)") << "\n";
+        if (threads < maxThreads && threads * 2 > maxThreads) {
+            threads = maxThreads / 2;
+        }
+    }
+    return passed;
+}
+
+// Перевіряє ConcurrentTaskMananger під одночасними додаваннями, видаленнями та запитами з кількох потоків.
+// Кожен потік працює зі своїми назвами (результат кожної операції відомий наперед) і з кількома спільними,
+// за які змагаються всі потоки; наприкінці спільні завдання перелічуються й звіряються з лічильниками.
+// Повертає false і виводить опис, якщо знайдено хоча б одну невідповідність
+bool runConcurrencyCheck(unsigned threads, std::size_t operationsPerThread) {
+    ConcurrentTaskMananger manager(8);
+    const std::int32_t firstDay = daysFromCivil(2024, 1, 1);
+    const std::int32_t dayCount = 60;
+    const std::size_t sharedNames = 16;
+    std::vector<std::atomic<long>> sharedBalance(sharedNames);  // Додано мінус видалено для кожної спільної назви
+    std::atomic<std::size_t> privateLeft{0};  // Власні завдання потоків, які мають лишитися наприкінці
+    std::atomic<std::size_t> failures{0};
+    std::mutex reportMutex;
+    auto fail = [&](const std::string& message) {
+        if (failures.fetch_add(1) < 10) {
+            std::lock_guard<std::mutex> lock(reportMutex);
+            std::cerr << "concurrency check: " << message << "\n";
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            std::uint64_t seed = 42 + t;  // Детермінований генератор (LCG) для кожного потоку
+            auto next = [&seed]() {
+                seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+                return static_cast<std::size_t>(seed >> 33);
+            };
+            ParsedTask parsed;
+            std::string name, description;
+            std::vector<std::size_t> live;  // Номери власних завдань, що зараз є в менеджері
+            std::size_t created = 0;
+            for (std::size_t i = 0; i < operationsPerThread; ++i) {
+                std::size_t choice = next() % 10;
+                if (choice < 3) {
+                    // Власне завдання: опис і дедлайн однозначно визначаються номером
+                    std::size_t id = created++;
+                    name = "own-" + std::to_string(t) + "-" + std::to_string(id);
+                    description = "owned by " + std::to_string(t);
+                    parsed.kind = id % 2 ? TaskKind::Important : TaskKind::Normal;
+                    parsed.priority = id % 2 ? static_cast<int>(id % 10) + 1 : 0;
+                    parsed.name = name;
+                    parsed.description = description;
+                    parsed.deadlineDay = firstDay + static_cast<std::int32_t>(id % dayCount);
+                    if (!manager.addTask(parsed)) {
+                        fail("add of " + name + " was rejected");
+                    }
+                    live.push_back(id);
+                } else if (choice < 5 && !live.empty()) {
+                    std::size_t slot = next() % live.size();
+                    std::size_t id = live[slot];
+                    live[slot] = live.back();
+                    live.pop_back();
+                    name = "own-" + std::to_string(t) + "-" + std::to_string(id);
+                    if (!manager.deleteTask(name)) {
+                        fail("delete of live task " + name + " failed");
+                    }
+                    TaskRecord record;
+                    if (manager.findTask(name, record)) {
+                        fail("deleted task " + name + " is still found");
+                    }
+                } else if (choice < 8 && !live.empty()) {
+                    std::size_t id = live[next() % live.size()];
+                    name = "own-" + std::to_string(t) + "-" + std::to_string(id);
+                    TaskRecord record;
+                    if (!manager.findTask(name, record)) {
+                        fail("live task " + name + " is not found");
+                    } else if (record.name != name || record.description != "owned by " + std::to_string(t) ||
+                               record.deadlineDay != firstDay + static_cast<std::int32_t>(id % dayCount)) {
+                        fail("task " + name + " came back with other data");
+                    }
+                } else if (choice < 9) {
+                    // Спільна назва: успішне видалення зменшує лічильник, тож він не може стати від'ємним
+                    std::size_t shared = next() % sharedNames;
+                    name = "shared-" + std::to_string(shared);
+                    if (next() % 2) {
+                        parsed.kind = TaskKind::Normal;
+                        parsed.priority = 0;
+                        parsed.name = name;
+                        parsed.description = "shared";
+                        parsed.deadlineDay = firstDay;
+                        sharedBalance[shared].fetch_add(1);
+                        manager.addTask(parsed);
+                    } else if (manager.deleteTask(name)) {
+                        sharedBalance[shared].fetch_sub(1);
+                    }
+                } else {
+                    // Запит за кількома сегментами: кожен запис має бути цілим і в межах діапазону
+                    std::int32_t from = firstDay + static_cast<std::int32_t>(next() % dayCount);
+                    std::vector<TaskRecord> records = manager.tasksDueBetween(tmFromDay(from), tmFromDay(from + 6));
+                    for (std::size_t r = 0; r < records.size(); ++r) {
+                        if (records[r].deadlineDay < from || records[r].deadlineDay > from + 6 || records[r].name.empty() ||
+                            (r > 0 && records[r - 1].deadlineDay > records[r].deadlineDay)) {
+                            fail("range query returned a task outside the range or out of order");
+                            break;
+                        }
+                    }
+                }
+            }
+            privateLeft.fetch_add(live.size());
+        });
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    // Після завершення потоків у менеджері мають бути рівно власні живі завдання та баланс спільних
+    std::size_t expected = privateLeft.load();
+    for (std::size_t shared = 0; shared < sharedNames; ++shared) {
+        long balance = sharedBalance[shared].load();
+        std::string name = "shared-" + std::to_string(shared);
+        long found = 0;
+        while (manager.deleteTask(name)) {
+            ++found;
+        }
+        if (found != balance) {
+            fail(name + ": " + std::to_string(found) + " tasks left, expected " + std::to_string(balance));
+        }
+    }
+    if (manager.size() != expected) {
+        fail("size " + std::to_string(manager.size()) + ", expected " + std::to_string(expected));
+    }
+    std::cout << "concurrency check, " << threads << " threads x " << operationsPerThread << " operations: "
+              << (failures.load() == 0 ? "passed" : "FAILED") << "\n";
+    return failures.load() == 0;
+}
+
+// Перевірки поведінки, яку не видно з виводу бенчмарків (режим --self-test).
+// Кожна перевірка виводить свій результат і повертає false, якщо він не збігся з очікуваним
+class SelfTest {
+    std::size_t failures = 0;
+
+    // Записує невдачу з поясненням
+    void fail(const std::string& check, const std::string& message) {
+        ++failures;
+        std::cerr << check << ": " << message << "\n";
+    }
+
+    // Чи має менеджер завдання з такою назвою та описом
+    static bool hasTask(const TaskMananger& manager, std::string_view name, std::string_view description) {
+        const Task* task = manager.findTask(name);
+        return task && task->getDescription() == description;
+    }
+
+    // Назви й описи завдань у порядку списку
+    static std::vector<std::string> listed(const TaskMananger& manager) {
+        std::vector<std::string> result;
+        for (const Task* task : manager.getTasks()) {
+            result.push_back(std::string(task->getName()) + "|" + std::string(task->getDescription()));
+        }
+        return result;
+    }
+
+public:
+    // Файл, збережений версією без екранування, читається дослівно — і повністю, і потоковим запитом
+    void legacyTextFile();
+
+    // Поля з '|', '\\' та переведеннями рядка переживають збереження й завантаження
+    void escapedRoundTrip();
+
+    // Знімок і журнал відтворюють стан, у якому видалення за назвою знаходять ті самі завдання,
+    // навіть якщо між додаванням і видаленням були сортування та ущільнення
+    void journalReplay();
+
+    // Виконує всі перевірки; повертає true, якщо всі пройшли
+    bool run();
+};
+
+void SelfTest::legacyTextFile() {
+    const std::string fileName = "self_test_legacy.txt";
+    {
+        std::ofstream file(fileName);
+        file << "Normal|copy C:\\new\\reports|C:\\temp\\x|2024-01-01\n"
+             << "Important|a\\\\b|tab\\there|2024-02-01|3\n";
+    }
+    for (bool streamed : {false, true}) {
+        TaskMananger manager;
+        manager.setVerbose(false);
+        TaskQuery query;
+        query.filter.fromDay = daysFromCivil(2000, 1, 1);  // Умова вмикає потоковий розбір
+        LoadReport report = streamed ? manager.loadMatching(fileName, query) : manager.loadFromFile(fileName);
+        const char* check = streamed ? "legacy text file (streamed)" : "legacy text file";
+        if (report.loaded != 2 || report.rejected != 0) {
+            fail(check, "loaded " + std::to_string(report.loaded) + " tasks, rejected " + std::to_string(report.rejected));
+        }
+        if (!hasTask(manager, "copy C:\\new\\reports", "C:\\temp\\x") || !hasTask(manager, "a\\\\b", "tab\\there")) {
+            fail(check, "backslashes were not kept verbatim");
+        }
+    }
+    std::remove(fileName.c_str());
+}
+
+void SelfTest::escapedRoundTrip() {
+    const std::string fileName = "self_test_escaped.txt";
+    const std::string_view names[] = {"pipe|name", "back\\slash", "line\nbreak", "plain"};
+    TaskMananger saved;
+    saved.setVerbose(false);
+    for (std::string_view name : names) {
+        saved.addTask(new NormalTask(TaskString(name), TaskString(std::string(name) + "|\r\\n"), daysFromCivil(2024, 1, 1)));
+    }
+    saved.saveToFile(fileName);
+
+    TaskMananger loaded;
+    loaded.setVerbose(false);
+    LoadReport report = loaded.loadFromFile(fileName);
+    if (report.loaded != std::size(names) || report.rejected != 0) {
+        fail("escaped round trip", "loaded " + std::to_string(report.loaded) + " tasks, rejected " + std::to_string(report.rejected));
+    }
+    for (std::string_view name : names) {
+        if (!hasTask(loaded, name, std::string(name) + "|\r\\n")) {
+            fail("escaped round trip", "task " + std::string(name) + " changed");
+        }
+    }
+    std::remove(fileName.c_str());
+}
+
+void SelfTest::journalReplay() {
+    const std::string base = "self_test_journal";
+    const std::int32_t day = daysFromCivil(2024, 1, 1);
+    for (bool compact : {false, true}) {
+        const char* check = compact ? "journal replay (compacted)" : "journal replay";
+        std::remove((base + snapshotExtension).c_str());
+        std::remove((base + journalExtension).c_str());
+
+        TaskMananger live;
+        live.setVerbose(false);
+        live.openJournal(base);
+        live.addTask(new NormalTask(TaskString("x"), TaskString("first"), day + 120));
+        live.addTask(new NormalTask(TaskString("x"), TaskString("second"), day));
+        live.addTask(new ImportantTask(TaskString("y"), TaskString("a"), day + 60, 2));
+        live.addTask(new NormalTask(TaskString("x"), TaskString("third"), day + 30));
+        live.addTask(new ImportantTask(TaskString("y"), TaskString("b"), day + 14, 5));
+        live.sortTasks(SortField::Deadline);
+        if (compact) {
+            live.compactJournal();
+        }
+        live.deleteTask("x");
+        live.addTask(new NormalTask(TaskString("x"), TaskString("fourth"), day + 7));
+        live.sortTasks(SortField::Importance, SortField::Deadline);
+        if (compact) {
+            live.compactJournal();
+        }
+        live.deleteTask("y");
+        live.closeJournal();
 
-        // Виконати дію на основі вибору користувача
-        switch (choice) {
-            case 1:
-                addTask();  // Додати звичайне завдання
+        TaskMananger replayed;
+        replayed.setVerbose(false);
+        replayed.openJournal(base);
+        replayed.closeJournal();
+        // Подальші видалення перевіряють, що й порядок за віком збігся, а не лише вміст списку
+        for (const char* name : {"", "x", "x", "y"}) {
+            if (*name) {
+                live.deleteTask(name);
+                replayed.deleteTask(name);
+            }
+            if (listed(live) != listed(replayed)) {
+                fail(check, std::string("replayed tasks differ from the live ones") + (*name ? " after deleting " : "") + name);
                 break;
-            case 2: {
-                std::string name, description, deadlineStr;
-                int priority;
-                std::tm deadline = {};
+            }
+        }
+    }
+    std::remove((base + snapshotExtension).c_str());
+    std::remove((base + journalExtension).c_str());
+}
 
-                std::cin.ignore();  // Ігноруємо символ нового рядка
-                std::cout << "Enter task name: ";  // Запитуємо назву завдання
-                std::getline(std::cin, name);
-                std::cout << "Enter task description: ";  // Запитуємо опис завдання
-                std::getline(std::cin, description);
-                std::cout << "Enter task deadline (YYYY-MM-DD): ";  // Запитуємо дедлайн
-                std::getline(std::cin, deadlineStr);
+bool SelfTest::run() {
+    legacyTextFile();
+    escapedRoundTrip();
+    journalReplay();
+    std::cout << "self-test: " << (failures == 0 ? "passed" : "FAILED") << "\n";
+    return failures == 0;
+}
 
-                // Перевіряємо коректність формату дати
-                if (strptime(deadlineStr.c_str(), "%Y-%m-%d", &deadline) == nullptr) {
-                    std::cout << "Invalid date format. Please use YYYY-MM-DD.\n";
-                    break;
-                }
+// Порівнює перегляд списку завдань із переглядом стовпчикового сховища;
+// повертає false, якщо не пройшла перевірка узгодженості сегментованого менеджера
+bool runBenchmarks(std::size_t count) {
+    TaskMananger manager;
+    std::uint64_t seed = 42;  // Детермінований генератор (LCG)
+    auto next = [&seed]() {
+        seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+        return static_cast<std::uint32_t>(seed >> 33);
+    };
 
-                // Запитуємо пріоритет завдання, доки не буде введено коректне значення
-                do {
-                    std::cout << "Enter priority (1-10): ";
-                    std::cin >> priority;
+    const std::string_view description = "benchmark task with a description longer than the inline string buffer";
 
-                    if (std::cin.fail()) {
-                        std::cin.clear();  // Очищуємо стан помилки
-                        std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');  // Пропускаємо некоректний ввід
-                        std::cout << "Invalid input. Please enter a number.\n";
-                    } else if (priority < 1 || priority > 10) {
-                        std::cout << "Priority must be between 1 and 10.\n";  // Перевірка діапазону
-                    }
-                } while (std::cin.fail() || priority < 1 || priority > 10);
+    // Завдання, створені через new (кожне завдання та кожен довгий рядок — окреме виділення)
+    std::size_t allocationsBefore = allocationsSoFar();
+    double heapMs = measureMs([&]() {
+        TaskMananger heapManager;
+        for (std::size_t i = 0; i < count; ++i) {
+            std::tm deadline = tmFromDay(daysFromCivil(2024, 1, 1) + static_cast<std::int32_t>(next() % 1096));
+            std::string name = "task-" + std::to_string(i);
+            if (next() % 4 == 0) {
+                heapManager.addTask(new ImportantTask(TaskString(name), TaskString(description), deadline, 1 + next() % 10));
+            } else {
+                heapManager.addTask(new NormalTask(TaskString(name), TaskString(description), deadline));
+            }
+        }
+    });
+    double heapAllocations = static_cast<double>(allocationsSoFar() - allocationsBefore) / static_cast<double>(count);
+    std::cout << "add + clear " << count << " heap tasks:  " << heapMs << " ms";
+    if (countsAllocations) {
+        std::cout << ", " << heapAllocations << " allocations per task";
+    }
+    std::cout << "\n";
 
-                // Додаємо важливе завдання
-                taskManager.addTask(new ImportantTask(name, description, deadline, priority));
-                std::cout << "Important task added successfully.\n";
-                break;
+    // Ті самі завдання в арені менеджера
+    seed = 42;
+    allocationsBefore = allocationsSoFar();
+    double addMs = measureMs([&]() {
+        ParsedTask parsed;
+        parsed.description = description;
+        for (std::size_t i = 0; i < count; ++i) {
+            parsed.deadlineDay = daysFromCivil(2024, 1, 1) + static_cast<std::int32_t>(next() % 1096);
+            std::string name = "task-" + std::to_string(i);
+            parsed.name = name;
+            parsed.kind = next() % 4 == 0 ? TaskKind::Important : TaskKind::Normal;
+            parsed.priority = parsed.kind == TaskKind::Important ? 1 + next() % 10 : 0;
+            manager.addTask(manager.createTask(parsed));
+        }
+    });
+    double arenaAllocations = static_cast<double>(allocationsSoFar() - allocationsBefore) / static_cast<double>(count);
+    std::cout << "add " << count << " arena tasks:        " << addMs << " ms";
+    if (countsAllocations) {
+        std::cout << ", " << arenaAllocations << " allocations per task";
+    }
+    std::cout << "\n";
+
+    TaskFilter filter;
+    filter.fromDay = daysFromCivil(2025, 6, 1);
+    filter.minPriority = 5;
+
+    std::size_t listMatches = 0;
+    double listMs = measureMs([&]() {
+        for (Task* task : manager.getTasks()) {
+            listMatches += filter.matches(task->kind(), task->priority(), task->getDeadlineDay());
+        }
+    });
+    std::cout << "list scan:     " << listMs << " ms (" << listMatches << " matches)\n";
+
+    std::size_t storeMatches = 0;
+    double storeMs = measureMs([&]() { storeMatches = manager.countTasks(filter); });
+    std::cout << "columnar scan: " << storeMs << " ms (" << storeMatches << " matches)\n";
+
+    // Пошук за словами: перегляд усіх описів проти інвертованого індексу
+    const std::string needle = "task-" + std::to_string(count / 2);
+    std::size_t scanMatches = 0;
+    double scanMs = measureMs([&]() {
+        for (Task* task : manager.getTasks()) {
+            scanMatches += std::string_view(task->getName()) == needle;
+        }
+    });
+    std::cout << "text scan for \"" << needle << "\": " << scanMs << " ms (" << scanMatches << " matches)\n";
+    manager.searchTasks("warm*");  // Перший пошук за префіксом впорядковує словник
+    for (std::string_view query : {std::string_view(needle), std::string_view("task-4242*"), std::string_view("task-42* OR task-77*"),
+                                    std::string_view("task-4*"), std::string_view("benchmark buffer")}) {
+        const int repeats = 10;
+        std::size_t searchMatches = 0;
+        double searchMs = measureMs([&]() {
+            for (int i = 0; i < repeats; ++i) {
+                searchMatches = manager.searchTasks(query, filter).size();
             }
-            case 3:
-                deleteTask();  // Видалити завдання
-                break;
-            case 4:
-                printTasks();  // Вивести усі завдання
-                break;
-            case 5:
-                filterTasks();  // Фільтрувати завдання за дедлайном
-                break;
-            case 6:
-                taskManager.sortByImportance();  // Сортувати завдання за важливістю
-                break;
-            case 7:
-                saveToFile();  // Зберегти завдання у файл
-                break;
-            case 8:
-                loadFromFile();  // Завантажити завдання з файлу
-                break;
-            case 9:
-                std::cout << "Exiting...\n";  // Вихід з програми
-                return;
-            default:
-                std::cout << "Invalid choice. Please select again.\n";  // Невірний вибір
+        });
+        std::cout << "search \"" << query << "\" with deadline filter: " << searchMs / repeats << " ms (" << searchMatches << " matches)\n";
+    }
+
+    // Масштабування завантаження файлу від 1 до N потоків
+    const std::string fileName = "bench_tasks.txt";
+    manager.saveToFile(fileName);
+    unsigned maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        TaskMananger loaded;
+        loaded.setLoadThreads(threads);
+        double loadMs = measureMs([&]() { loaded.loadFromFile(fileName); });
+        std::cout << "load with " << threads << " threads: " << loadMs << " ms (" << loaded.size() << " tasks)\n";
+        if (threads < maxThreads && threads * 2 > maxThreads) {
+            threads = maxThreads / 2;  // Останній вимір — з усіма ядрами
+        }
+    }
+    std::remove(fileName.c_str());
+
+    // Збереження та відновлення бінарного знімка
+    const std::string snapshotName = std::string("bench_tasks") + snapshotExtension;
+    double saveMs = measureMs([&]() { manager.saveToFile(snapshotName); });
+    TaskMananger restored;
+    restored.setLoadThreads(maxThreads);
+    double restoreMs = measureMs([&]() { restored.loadFromFile(snapshotName); });
+    // Індекси назв, дедлайнів і терміновості після відновлення будуються під час першого звернення
+    double indexMs = measureMs([&]() {
+        restored.findTask("task-0");
+        restored.nextDue(1);
+    });
+    std::cout << "snapshot save: " << saveMs << " ms, restore with " << maxThreads << " threads: " << restoreMs << " ms ("
+              << restored.size() << " tasks), first lookups build indexes: " << indexMs << " ms\n";
+
+    // Видалення кожної десятої назви: по одній проти одного проходу deleteTasks; далі deleteWhere
+    {
+        std::vector<std::string> names;
+        for (std::size_t i = 0; i < count; i += 10) {
+            names.push_back("task-" + std::to_string(i));
         }
+        std::vector<std::string_view> nameViews(names.begin(), names.end());
+        TaskMananger single;
+        single.setVerbose(false);
+        single.loadFromFile(snapshotName);
+        double singleMs = measureMs([&]() {
+            for (std::string_view name : nameViews) {
+                single.deleteTask(name);
+            }
+        });
+        std::size_t bulkDeleted = 0;
+        double bulkMs = measureMs([&]() { bulkDeleted = restored.deleteTasks(nameViews); });
+        std::cout << "delete " << bulkDeleted << " by name: one by one " << singleMs << " ms, batch " << bulkMs << " ms\n";
+
+        TaskFilter overdue;
+        overdue.toDay = daysFromCivil(2024, 12, 31);
+        overdue.maxPriority = 4;
+        std::size_t whereDeleted = 0;
+        double whereMs = measureMs([&]() { whereDeleted = restored.deleteWhere(overdue); });
+        std::cout << "deleteWhere (before 2025, priority < 5): " << whereMs << " ms (" << whereDeleted << " tasks)\n";
+    }
+    std::remove(snapshotName.c_str());
+
+    // Журнал змін: кожна зміна коштує один запис, fsync — один на групу записів
+    {
+        const std::string journalBase = "bench_journal";
+        TaskMananger journaled;
+        journaled.setVerbose(false);
+        journaled.openJournal(journalBase);
+        const std::size_t changes = std::min<std::size_t>(count, 100000);
+        ParsedTask parsed;
+        parsed.description = description;
+        double journalMs = measureMs([&]() {
+            for (std::size_t i = 0; i < changes; ++i) {
+                std::string name = "journal-" + std::to_string(i);
+                parsed.name = name;
+                parsed.deadlineDay = daysFromCivil(2024, 1, 1) + static_cast<std::int32_t>(i % 1096);
+                journaled.addTask(journaled.createTask(parsed));
+            }
+            journaled.syncJournal();
+        });
+        std::cout << "journaled adds: " << changes << " in " << journalMs << " ms ("
+                  << static_cast<std::size_t>(changes / journalMs * 1000.0) << " ops/s, with compactions)\n";
+        double compactMs = measureMs([&]() { journaled.compactJournal(); });
+        std::cout << "journal compaction: " << compactMs << " ms (" << journaled.size() << " tasks)\n";
+        journaled.closeJournal();
+        TaskMananger replayed;
+        replayed.setVerbose(false);
+        double replayMs = measureMs([&]() { replayed.openJournal(journalBase); });
+        std::cout << "journal open: " << replayMs << " ms (" << replayed.size() << " tasks)\n";
+        replayed.closeJournal();
+        std::remove((journalBase + snapshotExtension).c_str());
+        std::remove((journalBase + journalExtension).c_str());
     }
+
+    return runConcurrencyBenchmark(count);
 }
 
-// Додає звичайне завдання
-void Menu::addTask() {
-    std::string name, description, deadlineStr;
-    std::tm deadline = {};
+// Детермінований генератор завдань для вимірювань: однакові seed і параметри дають однакову послідовність.
+// Дедлайни скупчені біля 2024-01-01 (у середньому за 30 днів, найпізніші — за 3 роки),
+// пріоритети та слова описів розподілені за законом Ципфа (перші значення трапляються найчастіше).
+class TaskGenerator {
+    static constexpr const char* words[] = {
+        "report", "review", "meeting", "deploy", "fix", "update", "client", "budget", "design", "test",
+        "release", "invoice", "plan", "draft", "email", "call", "server", "backup", "migrate", "refactor",
+        "document", "schedule", "order", "contract", "audit", "training", "hiring", "survey", "launch", "demo",
+        "sprint", "roadmap", "security", "database", "network", "support", "ticket", "feedback", "prototype", "research"};
+    static constexpr std::size_t wordCount = sizeof(words) / sizeof(words[0]);
 
-    std::cin.ignore();  // Ігноруємо символ нового рядка
-    std::cout << "Enter task name: ";  // Запитуємо назву завдання
-    std::getline(std::cin, name);
-    std::cout << "Enter task description: ";  // Запитуємо опис завдання
-    std::getline(std::cin, description);
-    std::cout << "Enter task deadline (YYYY-MM-DD): ";  // Запитуємо дедлайн
-    std::getline(std::cin, deadlineStr);
+    std::uint64_t state;                 // Стан генератора (LCG)
+    unsigned importantPercent;           // Частка важливих завдань у відсотках
+    std::size_t index = 0;               // Номер наступного завдання
+    std::vector<double> priorityWeights; // Накопичені ваги пріоритетів 1..10
+    std::vector<double> wordWeights;     // Накопичені ваги слів
+    std::string name;                    // Назва поточного завдання
+    std::string description;             // Опис поточного завдання
 
-    // Перевіряємо коректність формату дати
-    if (strptime(deadlineStr.c_str(), "%Y-%m-%d", &deadline) == nullptr) {
-        std::cout << "Invalid date format. Please use YYYY-MM-DD.\n";
-        return;
+    // Наступне псевдовипадкове число з [0, 1)
+    double uniform();
+
+    // Вибирає номер за накопиченими вагами
+    std::size_t pick(const std::vector<double>& weights);
+
+public:
+    TaskGenerator(std::uint64_t seed, unsigned importantPercent);
+
+    // Заповнює parsed наступним завданням (рядки дійсні до наступного виклику)
+    void next(ParsedTask& parsed);
+};
+
+TaskGenerator::TaskGenerator(std::uint64_t seed, unsigned importantPercent) : state(seed), importantPercent(importantPercent) {
+    double total = 0;
+    for (int rank = 1; rank <= 10; ++rank) {
+        priorityWeights.push_back(total += 1.0 / rank);
     }
+    total = 0;
+    for (std::size_t rank = 1; rank <= wordCount; ++rank) {
+        wordWeights.push_back(total += 1.0 / static_cast<double>(rank));
+    }
+}
 
-    // Додаємо звичайне завдання
-    taskManager.addTask(new NormalTask(name, description, deadline));
-    std::cout << "Normal task added successfully.\n";
+double TaskGenerator::uniform() {
+    state = state * 6364136223846793005ull + 1442695040888963407ull;
+    return static_cast<double>(state >> 11) / 9007199254740992.0;  // 53 старші біти
 }
 
-// Видаляє завдання за назвою
-void Menu::deleteTask() {
-    std::string name;
+std::size_t TaskGenerator::pick(const std::vector<double>& weights) {
+    auto it = std::upper_bound(weights.begin(), weights.end(), uniform() * weights.back());
+    return std::min(static_cast<std::size_t>(it - weights.begin()), weights.size() - 1);
+}
 
-    std::cin.ignore();  // Ігноруємо символ нового рядка
-    std::cout << "Enter task name to delete: ";  // Запитуємо назву завдання для видалення
-    std::getline(std::cin, name);
+void TaskGenerator::next(ParsedTask& parsed) {
+    name = "task-" + std::to_string(index++);
+    description.clear();
+    std::size_t length = 3 + static_cast<std::size_t>(uniform() * 6);
+    for (std::size_t i = 0; i < length; ++i) {
+        if (i > 0) {
+            description += ' ';
+        }
+        description += words[pick(wordWeights)];
+    }
 
-    // Якщо завдання знайдено і видалено
-    if (taskManager.deleteTask(name)) {
-        std::cout << "Task deleted successfully.\n";
-    } else {
-        std::cout << "Task not found.\n";  // Якщо завдання не знайдено
+    double offset = std::min(-std::log(1.0 - uniform()) * 30.0, 1095.0);  // Показниковий розподіл, середнє — 30 днів
+    parsed.kind = uniform() * 100 < importantPercent ? TaskKind::Important : TaskKind::Normal;
+    parsed.priority = parsed.kind == TaskKind::Important ? static_cast<int>(pick(priorityWeights)) + 1 : 0;
+    parsed.deadlineDay = daysFromCivil(2024, 1, 1) + static_cast<std::int32_t>(offset);
+    parsed.name = name;
+    parsed.description = description;
+}
+
+// Записує count згенерованих завдань у файл завдань; повертає false у разі помилки
+bool writeGeneratedTasks(const std::string& fileName, std::size_t count, unsigned importantPercent, std::uint64_t seed) {
+    std::ofstream file(fileName);
+    if (!file.is_open()) {
+        return false;
+    }
+    TaskGenerator generator(seed, importantPercent);
+    ParsedTask parsed;
+    char date[32];
+    for (std::size_t i = 0; i < count; ++i) {
+        generator.next(parsed);
+        formatDay(parsed.deadlineDay, date);
+        file << kindInfo(parsed.kind).name << "|" << parsed.name << "|" << parsed.description << "|" << date;
+        if (kindInfo(parsed.kind).hasPriority) {
+            file << "|" << parsed.priority;
+        }
+        file << "\n";
     }
+    return static_cast<bool>(file);
 }
 
-// Виводить усі завдання
-void Menu::printTasks() {
-    taskManager.printTasks();  // Викликаємо функцію виведення завдань менеджера завдань
+// Скидає пікове значення RSS процесу (якщо ядро це підтримує), щоб виміряти пік однієї операції
+void resetPeakRss() {
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    clearRefs << "5";
 }
 
-// Фільтрує завдання за дедлайном
-void Menu::filterTasks() {
-    std::string deadlineStr;
-    std::tm deadline = {};
+// Повертає пікове значення RSS у КіБ: VmHWM після resetPeakRss або, якщо його немає, максимум за весь час роботи
+long peakRssKb() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) {
+            return std::strtol(line.c_str() + 6, nullptr, 10);
+        }
+    }
+    struct rusage usage;
+    ::getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
 
-    std::cin.ignore();  // Ігноруємо символ нового рядка
-    std::cout << "Enter the deadline (YYYY-MM-DD) to filter tasks: ";  // Запитуємо дедлайн для фільтрації
-    std::getline(std::cin, deadlineStr);
+// Виконує функцію, відправивши стандартний вивід у /dev/null (щоб виміряти операцію, а не термінал)
+template <typename Function>
+void withoutStdout(Function&& function) {
+    std::cout.flush();
+    int saved = ::dup(STDOUT_FILENO);
+    int null = ::open("/dev/null", O_WRONLY);
+    if (saved < 0 || null < 0) {
+        function();  // Не вдалося перенаправити — вимірюємо як є
+    } else {
+        ::dup2(null, STDOUT_FILENO);
+        function();
+        std::cout.flush();
+        ::dup2(saved, STDOUT_FILENO);
+    }
+    if (null >= 0) {
+        ::close(null);
+    }
+    if (saved >= 0) {
+        ::close(saved);
+    }
+}
 
-    // Перевіряємо коректність формату дати
-    if (strptime(deadlineStr.c_str(), "%Y-%m-%d", &deadline) == nullptr) {
-        std::cout << "Invalid date format. Please use YYYY-MM-DD.\n";
-        return;
+// Результат вимірювання однієї операції
+struct OperationStats {
+    std::string name;                // Назва операції
+    std::size_t tasks = 0;           // Розмір набору завдань
+    std::size_t items = 0;           // Скільки завдань оброблено за всі виклики
+    std::vector<double> latencies;   // Тривалість кожного виклику, мкс
+    long peakRssKb = 0;              // Пікове RSS під час операції
+};
+
+// Виводить результати таблицею або CSV
+void printOperationStats(const std::vector<OperationStats>& results, bool csv) {
+    const char* columns[] = {"tasks", "operation", "ops", "ops/s", "items/s", "p50 us", "p90 us", "p99 us", "max us", "peak RSS MiB"};
+    for (std::size_t i = 0; i < 10; ++i) {
+        if (csv) {
+            std::cout << (i ? "," : "") << columns[i];
+        } else {
+            std::cout << std::left << std::setw(i == 1 ? 26 : 12) << columns[i];
+        }
     }
+    std::cout << "\n";
 
-    // Фільтруємо завдання за дедлайном
-    taskManager.filterTasksByDeadline(deadline);
+    for (const OperationStats& stats : results) {
+        if (stats.latencies.empty()) {
+            // Операцію не викликали жодного разу — вимірювати нічого
+            if (csv) {
+                std::cout << stats.tasks << "," << stats.name << ",0,n/a,n/a,n/a,n/a,n/a,n/a,n/a\n";
+            } else {
+                std::cout << std::left << std::setw(12) << stats.tasks << std::setw(26) << stats.name << std::setw(12) << 0 << "n/a\n";
+            }
+            continue;
+        }
+        std::vector<double> sorted = stats.latencies;
+        std::sort(sorted.begin(), sorted.end());
+        double totalUs = 0;
+        for (double latency : sorted) {
+            totalUs += latency;
+        }
+        auto percentile = [&sorted](double fraction) {
+            std::size_t rank = static_cast<std::size_t>(std::ceil(fraction * static_cast<double>(sorted.size())));
+            return sorted[rank > 0 ? rank - 1 : 0];  // Метод найближчого рангу
+        };
+        double seconds = totalUs / 1e6;
+        double values[] = {static_cast<double>(sorted.size()) / seconds, static_cast<double>(stats.items) / seconds,
+                           percentile(0.5), percentile(0.9), percentile(0.99), sorted.back(), stats.peakRssKb / 1024.0};
+
+        if (csv) {
+            std::cout << stats.tasks << "," << stats.name << "," << sorted.size();
+            for (double value : values) {
+                std::cout << "," << std::fixed << std::setprecision(1) << value;
+            }
+        } else {
+            std::cout << std::left << std::setw(12) << stats.tasks << std::setw(26) << stats.name << std::setw(12) << sorted.size();
+            for (double value : values) {
+                std::cout << std::setw(12) << std::fixed << std::setprecision(1) << value;
+            }
+        }
+        std::cout << std::defaultfloat << "\n";
+    }
 }
 
-// Зберігає завдання у файл
-void Menu::saveToFile() {
-    std::string fileName;
+// Найменший набір, на якому кожна операція виконується хоча б раз (deleteTask видаляє десяту частину набору)
+constexpr std::size_t minOperationBenchmarkSize = 10;
 
-    std::cin.ignore();  // Ігноруємо символ нового рядка
-    std::cout << "Enter file name to save tasks: ";  // Запитуємо назву файлу для збереження
-    std::getline(std::cin, fileName);
+// Вимірює основні операції TaskMananger на згенерованих наборах заданих розмірів:
+// кількість операцій за секунду, перцентилі тривалості викликів і пікове RSS для кожної операції
+void runOperationBenchmarks(const std::vector<std::size_t>& sizes, bool csv) {
+    std::vector<OperationStats> results;
+    for (std::size_t size : sizes) {
+        const std::string textName = "bench_ops_" + std::to_string(size) + ".txt";
+        const std::string snapshotName = "bench_ops_" + std::to_string(size) + snapshotExtension;
+        if (!writeGeneratedTasks(textName, size, 25, 42)) {
+            std::cerr << "Error: can't write " << textName << "\n";
+            return;
+        }
 
-    // Зберігаємо завдання у файл
-    taskManager.saveToFile(fileName);
+        // Вимірює count викликів функції call(i) — кожен окремо; items — скільки завдань оброблено
+        auto measure = [&results, size](const char* name, std::size_t count, std::size_t items, auto&& call) {
+            OperationStats stats;
+            stats.name = name;
+            stats.tasks = size;
+            stats.items = items;
+            stats.latencies.reserve(count);
+            resetPeakRss();
+            for (std::size_t i = 0; i < count; ++i) {
+                auto start = std::chrono::steady_clock::now();
+                call(i);
+                auto finish = std::chrono::steady_clock::now();
+                stats.latencies.push_back(std::chrono::duration<double, std::micro>(finish - start).count());
+            }
+            stats.peakRssKb = peakRssKb();
+            results.push_back(std::move(stats));
+        };
+
+        {
+            TaskMananger manager;
+            manager.setVerbose(false);
+            TaskGenerator generator(42, 25);
+            ParsedTask parsed;
+            measure("addTask", size, size, [&](std::size_t) {
+                generator.next(parsed);
+                manager.addTask(manager.createTask(parsed));
+            });
+
+            const std::size_t filters = 20;
+            withoutStdout([&]() {
+                measure("filterTasksByDeadline", filters, 0, [&](std::size_t i) {
+                    manager.filterTasksByDeadline(tmFromDay(daysFromCivil(2024, 1, 1) + static_cast<std::int32_t>(i * 15)));
+                });
+            });
+            results.back().items = 0;
+            for (std::size_t i = 0; i < filters; ++i) {
+                TaskFilter filter;
+                filter.fromDay = daysFromCivil(2024, 1, 1) + static_cast<std::int32_t>(i * 15);
+                results.back().items += manager.countTasks(filter);  // Кількість виведених завдань
+            }
+
+            measure("sortByImportance", 5, 5 * size, [&](std::size_t) { manager.sortByImportance(); });
+            measure("saveToFile (text)", 1, size, [&](std::size_t) { manager.saveToFile(textName); });
+            measure("saveToFile (snapshot)", 1, size, [&](std::size_t) { manager.saveToFile(snapshotName); });
+
+            // Видаляємо кожне 7-ме завдання з перших 70%
+            std::vector<std::string> names;
+            for (std::size_t i = 0; i < size / 10; ++i) {
+                names.push_back("task-" + std::to_string(i * 7));
+            }
+            measure("deleteTask", names.size(), names.size(), [&](std::size_t i) { manager.deleteTask(names[i]); });
+        }
+
+        {
+            TaskMananger manager;
+            manager.setVerbose(false);
+            measure("loadFromFile (text)", 1, size, [&](std::size_t) { manager.loadFromFile(textName); });
+        }
+        {
+            TaskMananger manager;
+            manager.setVerbose(false);
+            measure("loadFromFile (snapshot)", 1, size, [&](std::size_t) { manager.loadFromFile(snapshotName); });
+        }
+        std::remove(textName.c_str());
+        std::remove(snapshotName.c_str());
+    }
+    printOperationStats(results, csv);
 }
 
-// Завантажує завдання з файлу
-void Menu::loadFromFile() {
-    std::string fileName;
+// Фільтр "дедлайн не раніше X і пріоритет не менше P": перегляд списку завдань (перехід за вказівником на кожне)
+// проти ядер стовпчикового сховища. Кожен вимір — найкращий з кількох повторів
+void runScanBenchmark(std::size_t count) {
+    TaskArena arena;
+    std::vector<Task*> tasks;
+    TaskStore store;
+    tasks.reserve(count);
+    store.reserve(count);
+    TaskGenerator generator(42, 25);
+    ParsedTask parsed;
+    for (std::size_t i = 0; i < count; ++i) {
+        generator.next(parsed);
+        parsed.description = std::string_view();  // Описи фільтр не читає
+        Task* task = arena.create(parsed);
+        tasks.push_back(task);
+        store.append(parsed.kind, parsed.priority, parsed.deadlineDay, task);
+    }
 
-    std::cin.ignore(); // Ігноруємо символ нового рядка
-    std::cout << "Enter file name to load tasks: "; // Запитуємо назву файлу для загрузки
-    std::getline(std::cin, fileName);
+    TaskFilter filter;
+    filter.fromDay = daysFromCivil(2024, 1, 15);
+    filter.minPriority = 2;
+    const int repeats = 5;
+    auto best = [repeats](auto&& function) {
+        double result = std::numeric_limits<double>::max();
+        for (int i = 0; i < repeats; ++i) {
+            result = std::min(result, measureMs(function));
+        }
+        return result;
+    };
 
-     // Загружаєм завдання з файлу
-    taskManager.loadFromFile(fileName);
+    std::size_t listMatches = 0;
+    double listMs = best([&]() {
+        listMatches = 0;
+        for (Task* task : tasks) {
+            listMatches += filter.matches(task->kind(), task->priority(), task->getDeadlineDay());
+        }
+    });
+    std::cout << "task list scan (" << count << " tasks): " << listMs << " ms (" << listMatches << " matches)\n";
+
+    for (const auto& kernel : supportedScanKernels()) {
+        std::size_t matches = 0;
+        double kernelMs = best([&]() {
+            matches = 0;
+            for (std::uint64_t word : store.selectBitmap(filter, kernel.second)) {
+                matches += static_cast<std::size_t>(__builtin_popcountll(word));
+            }
+        });
+        std::cout << kernel.first << " kernel count: " << kernelMs << " ms (" << matches << " matches, "
+                  << listMs / kernelMs << "x faster than the list scan)\n";
+    }
+
+    std::size_t selected = 0;
+    double selectMs = best([&]() { selected = store.select(filter).size(); });
+    std::cout << "select rows with the best kernel: " << selectMs << " ms (" << selected << " rows)\n";
+}
+
+// Розбирає невід'ємне число з аргументу командного рядка; повертає false, якщо це не число цілком
+template <typename Number>
+bool parseArgument(const char* text, Number& value) {
+    return parseNumber(std::string_view(text), value);
+}
+
+// Виводить підказку щодо аргументів програми
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [--verbose] [--journal base] [--metrics text|json] --batch [file] | -e \"command\" ... | --bench [count]"
+              << " | --bench-ops [--csv] [sizes ...] | --bench-scan [count] | --self-test | --check-concurrency [threads] [operations]"
+              << " | --generate file count [important percent] [seed]\n";
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+    // Режим вимірювання продуктивності: main --bench [кількість завдань]
+    if (argc > 1 && std::string(argv[1]) == "--bench") {
+        std::size_t count = 1000000;
+        if (argc > 2 && !parseArgument(argv[2], count)) {
+            printUsage(argv[0]);
+            return 2;
+        }
+        return runBenchmarks(count) ? 0 : 1;
+    }
+
+    // Перевірки поведінки: main --self-test
+    if (argc > 1 && std::string(argv[1]) == "--self-test") {
+        SelfTest test;
+        return test.run() ? 0 : 1;
+    }
+
+    // Перевірка потокобезпечності: main --check-concurrency [потоки] [операцій на потік] (типово 8 і 20000)
+    if (argc > 1 && std::string(argv[1]) == "--check-concurrency") {
+        unsigned threads = 8;
+        std::size_t operations = 20000;
+        if ((argc > 2 && (!parseArgument(argv[2], threads) || threads == 0)) || (argc > 3 && !parseArgument(argv[3], operations))) {
+            printUsage(argv[0]);
+            return 2;
+        }
+        return runConcurrencyCheck(threads, operations) ? 0 : 1;
+    }
+
+    // Вимірювання операцій на згенерованих наборах: main --bench-ops [--csv] [розмір ...] (типово 10000 100000 1000000)
+    if (argc > 1 && std::string(argv[1]) == "--bench-ops") {
+        bool csv = argc > 2 && std::string(argv[2]) == "--csv";
+        std::vector<std::size_t> sizes;
+        for (int i = csv ? 3 : 2; i < argc; ++i) {
+            std::size_t size = 0;
+            if (!parseArgument(argv[i], size)) {
+                printUsage(argv[0]);
+                return 2;
+            }
+            if (size < minOperationBenchmarkSize) {
+                std::cerr << "Error: --bench-ops sizes must be at least " << minOperationBenchmarkSize << "\n";
+                return 2;
+            }
+            sizes.push_back(size);
+        }
+        if (sizes.empty()) {
+            sizes = {10000, 100000, 1000000};
+        }
+        runOperationBenchmarks(sizes, csv);
+        return 0;
+    }
+
+    // Вимірювання ядер фільтрації: main --bench-scan [кількість завдань] (типово 10000000)
+    if (argc > 1 && std::string(argv[1]) == "--bench-scan") {
+        std::size_t count = 10000000;
+        if (argc > 2 && !parseArgument(argv[2], count)) {
+            printUsage(argv[0]);
+            return 2;
+        }
+        runScanBenchmark(count);
+        return 0;
+    }
+
+    // Генератор файлу завдань: main --generate файл кількість [відсоток важливих] [seed]
+    if (argc > 1 && std::string(argv[1]) == "--generate") {
+        std::size_t count = 0;
+        unsigned importantPercent = 25;
+        std::uint64_t seed = 42;
+        if (argc < 4 || !parseArgument(argv[3], count) || (argc > 4 && !parseArgument(argv[4], importantPercent)) ||
+            (argc > 5 && !parseArgument(argv[5], seed))) {
+            std::cerr << "Usage: " << argv[0] << " --generate file count [important percent] [seed]\n";
+            return 2;
+        }
+        if (!writeGeneratedTasks(argv[2], count, importantPercent, seed)) {
+            std::cerr << "Error: can't write " << argv[2] << "\n";
+            return 1;
+        }
+        return 0;
+    }
+
+    // Пакетний режим: main [--verbose] [--journal база] [--metrics text|json] --batch [файл команд]
+    // або main [--verbose] [--journal база] [--metrics text|json] -e "команда" [-e "команда" ...]
+    bool verbose = false;
+    std::string journalBase;  // Журнал змін вмикається і для меню, і для пакетного режиму
+    std::string metricsFormat;  // Формат лічильників, що виводяться у stderr при виході (порожньо — не виводити)
+    int arg = 1;
+    while (arg < argc) {
+        std::string option = argv[arg];
+        if (option == "--verbose") {
+            verbose = true;
+            ++arg;
+        } else if (option == "--journal" && arg + 1 < argc) {
+            journalBase = argv[arg + 1];
+            arg += 2;
+        } else if (option == "--metrics" && arg + 1 < argc && (std::string(argv[arg + 1]) == "text" || std::string(argv[arg + 1]) == "json")) {
+            metricsFormat = argv[arg + 1];
+            arg += 2;
+        } else {
+            break;
+        }
+    }
+    if (arg < argc) {
+        std::ios::sync_with_stdio(false);  // Без запитів потоки вводу та виводу не потрібно синхронізувати
+        std::cin.tie(nullptr);
+
+        Menu batch;
+        batch.setVerbose(verbose);
+        std::size_t errors = 0;
+        if (!journalBase.empty() && !batch.openJournal(journalBase)) {
+            ++errors;  // Команди виконуються, але код виходу повідомляє про помилку
+        }
+        std::string option = argv[arg];
+        if (option == "--batch") {
+            if (arg + 1 < argc && std::string(argv[arg + 1]) != "-") {
+                std::ifstream commands(argv[arg + 1]);
+                if (!commands.is_open()) {
+                    std::cerr << "Error: can't open command file " << argv[arg + 1] << "\n";
+                    return 2;
+                }
+                errors += batch.runBatch(commands);
+            } else {
+                errors += batch.runBatch(std::cin);  // Команди зі стандартного вводу
+            }
+        } else if (option == "-e") {
+            for (; arg + 1 < argc && std::string(argv[arg]) == "-e"; arg += 2) {
+                if (const char* error = batch.runCommand(argv[arg + 1])) {
+                    std::cerr << argv[arg + 1] << ": " << error << "\n";
+                    ++errors;
+                }
+            }
+            if (arg < argc) {
+                std::cerr << "Error: expected -e \"command\"\n";
+                return 2;
+            }
+        } else {
+            printUsage(argv[0]);
+            return 2;
+        }
+        if (!metricsFormat.empty()) {
+            batch.writeMetrics(std::cerr, metricsFormat == "json");
+        }
+        return errors == 0 ? 0 : 1;
+    }
+
     Menu menu;
+    if (!journalBase.empty()) {
+        menu.openJournal(journalBase);
+    }
     menu.handleInput();
+    if (!metricsFormat.empty()) {
+        menu.writeMetrics(std::cerr, metricsFormat == "json");
+    }
     return 0;
 }